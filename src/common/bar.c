@@ -87,7 +87,8 @@ void ffAppendPercentNum(FFinstance* instance, FFstrbuf* buffer, uint8_t percent,
                 ffStrbufAppendS(buffer, "\033[91m");
         }
     }
-    ffStrbufAppendF(buffer, "%u%%", (unsigned) percent);
+    ffStrbufAppendUInt(buffer, percent);
+    ffStrbufAppendC(buffer, '%');
 
     if (colored && !instance->config.pipe)
     {
@@ -0,0 +1,173 @@
+#include "fastfetch.h"
+#include "common/caching.h"
+#include "common/io/io.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#define FF_CACHE_MAGIC 0x31434646 // "FFC1"
+
+typedef struct FFCacheHeader
+{
+    uint32_t magic;
+    uint32_t keySize;
+    uint32_t dataSize;
+} FFCacheHeader;
+
+static void getCachePath(const FFinstance* instance, const char* name, FFstrbuf* path)
+{
+    ffStrbufAppend(path, &instance->state.platform.cacheDir);
+    ffStrbufAppendS(path, "fastfetch/detection/");
+    ffStrbufAppendS(path, name);
+}
+
+bool ffCacheReadStrbuf(const FFinstance* instance, const char* name, uint32_t keySize, const void* key, FFstrbuf* data)
+{
+    if(instance->config.recache)
+        return false;
+
+    FF_STRBUF_AUTO_DESTROY path;
+    ffStrbufInit(&path);
+    getCachePath(instance, name, &path);
+
+    FILE* file = fopen(path.chars, "rb");
+    if(file == NULL)
+        return false;
+
+    FFCacheHeader header;
+    bool valid =
+        fread(&header, sizeof(header), 1, file) == 1 &&
+        header.magic == FF_CACHE_MAGIC &&
+        header.keySize == keySize &&
+        header.dataSize < (1 << 24);
+
+    if(valid)
+    {
+        // Key and data are read in one go; one extra byte to detect files which are longer than expected
+        uint32_t size = keySize + header.dataSize;
+        ffStrbufClear(data);
+        ffStrbufEnsureFree(data, size + 1);
+        valid =
+            fread(data->chars, 1, size + 1, file) == size &&
+            memcmp(data->chars, key, keySize) == 0;
+
+        if(valid)
+        {
+            memmove(data->chars, data->chars + keySize, header.dataSize);
+            data->length = header.dataSize;
+        }
+        data->chars[data->length] = '\0';
+    }
+
+    fclose(file);
+    return valid;
+}
+
+#ifndef _WIN32
+const void* ffCacheMap(const FFinstance* instance, const char* name, uint32_t keySize, const void* key, uint32_t* dataSize)
+{
+    if(instance->config.recache)
+        return NULL;
+
+    FF_STRBUF_AUTO_DESTROY path;
+    ffStrbufInit(&path);
+    getCachePath(instance, name, &path);
+
+    int FF_AUTO_CLOSE_FD fd = open(path.chars, O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return NULL;
+
+    struct stat fileInfo;
+    if(fstat(fd, &fileInfo) != 0 || (size_t) fileInfo.st_size < sizeof(FFCacheHeader) + keySize)
+        return NULL;
+
+    uint8_t* content = mmap(NULL, (size_t) fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(content == MAP_FAILED)
+        return NULL;
+
+    const FFCacheHeader* header = (const FFCacheHeader*) content;
+    if(
+        header->magic != FF_CACHE_MAGIC ||
+        header->keySize != keySize ||
+        (size_t) fileInfo.st_size != sizeof(FFCacheHeader) + keySize + header->dataSize ||
+        memcmp(content + sizeof(FFCacheHeader), key, keySize) != 0
+    ) {
+        munmap(content, (size_t) fileInfo.st_size);
+        return NULL;
+    }
+
+    *dataSize = header->dataSize;
+    return content + sizeof(FFCacheHeader) + keySize;
+}
+#endif
+
+bool ffCacheGetBootId(char bootId[FF_CACHE_BOOT_ID_LENGTH])
+{
+    #ifdef __linux__
+        // Includes the trailing new line
+        return ffReadFileData("/proc/sys/kernel/random/boot_id", FF_CACHE_BOOT_ID_LENGTH, bootId) == FF_CACHE_BOOT_ID_LENGTH;
+    #else
+        FF_UNUSED(bootId);
+        return false;
+    #endif
+}
+
+bool ffCacheRead(const FFinstance* instance, const char* name, uint32_t keySize, const void* key, uint32_t dataSize, void* data)
+{
+    FF_STRBUF_AUTO_DESTROY content;
+    ffStrbufInit(&content);
+    if(!ffCacheReadStrbuf(instance, name, keySize, key, &content) || content.length != dataSize)
+        return false;
+
+    memcpy(data, content.chars, dataSize);
+    return true;
+}
+
+bool ffCacheWrite(const FFinstance* instance, const char* name, uint32_t keySize, const void* key, uint32_t dataSize, const void* data)
+{
+    FF_STRBUF_AUTO_DESTROY path;
+    ffStrbufInit(&path);
+    getCachePath(instance, name, &path);
+
+    FF_STRBUF_AUTO_DESTROY content;
+    ffStrbufInitA(&content, (uint32_t) sizeof(FFCacheHeader) + keySize + dataSize);
+    ffStrbufAppendNS(&content, sizeof(FFCacheHeader), (const char*) &(FFCacheHeader) {
+        .magic = FF_CACHE_MAGIC,
+        .keySize = keySize,
+        .dataSize = dataSize,
+    });
+    ffStrbufAppendNS(&content, keySize, key);
+    ffStrbufAppendNS(&content, dataSize, data);
+
+    // Write to a temporary file first, so concurrent instances never see a partially written cache.
+    // Every instance has its own one, otherwise two of them could write into the same file at the same time
+    FF_STRBUF_AUTO_DESTROY tmpPath;
+    ffStrbufInitCopy(&tmpPath, &path);
+    ffStrbufAppendC(&tmpPath, '.');
+    ffStrbufAppendUInt(&tmpPath, (uint64_t) getpid());
+    ffStrbufAppendS(&tmpPath, ".tmp");
+    if(!ffWriteFileBuffer(tmpPath.chars, &content))
+    {
+        remove(tmpPath.chars);
+        return false;
+    }
+
+    if(rename(tmpPath.chars, path.chars) != 0)
+    {
+        // Windows doesn't replace existing files
+        remove(path.chars);
+        if(rename(tmpPath.chars, path.chars) != 0)
+        {
+            remove(tmpPath.chars);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#ifndef FF_INCLUDED_common_caching
+#define FF_INCLUDED_common_caching
+
+#include "fastfetch.h"
+
+// Small binary blobs in <cacheDir>/fastfetch/detection/<name>.
+// The data is only returned if the stored key matches byte for byte, so the key must contain
+// everything that invalidates the data (boot id, mtimes, ...). --recache skips reading.
+#define FF_CACHE_BOOT_ID_LENGTH 37
+
+// Fills a key which changes on every boot, for data which is static until the next reboot. Linux only
+bool ffCacheGetBootId(char bootId[FF_CACHE_BOOT_ID_LENGTH]);
+
+bool ffCacheRead(const FFinstance* instance, const char* name, uint32_t keySize, const void* key, uint32_t dataSize, void* data);
+bool ffCacheReadStrbuf(const FFinstance* instance, const char* name, uint32_t keySize, const void* key, FFstrbuf* data);
+bool ffCacheWrite(const FFinstance* instance, const char* name, uint32_t keySize, const void* key, uint32_t dataSize, const void* data);
+
+#ifndef _WIN32
+// Maps the data read only instead of copying it. The mapping is kept until the process exits.
+// The data starts at offset 12 + keySize of the file, so keep keySize a multiple of the alignment the data needs
+const void* ffCacheMap(const FFinstance* instance, const char* name, uint32_t keySize, const void* key, uint32_t* dataSize);
+#endif
+
+static inline bool ffCacheWriteStrbuf(const FFinstance* instance, const char* name, uint32_t keySize, const void* key, const FFstrbuf* data)
+{
+    return ffCacheWrite(instance, name, keySize, key, data->length, data->chars);
+}
+
+#endif
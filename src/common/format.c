@@ -4,26 +4,24 @@
 #include "util/textModifier.h"
 #include "util/stringUtils.h"
 
-#include <inttypes.h>
-
 void ffFormatAppendFormatArg(FFstrbuf* buffer, const FFformatarg* formatarg)
 {
     if(formatarg->type == FF_FORMAT_ARG_TYPE_INT)
-        ffStrbufAppendF(buffer, "%i", *(int*)formatarg->value);
+        ffStrbufAppendSInt(buffer, *(int*)formatarg->value);
     else if(formatarg->type == FF_FORMAT_ARG_TYPE_UINT)
-        ffStrbufAppendF(buffer, "%" PRIu32, *(uint32_t*)formatarg->value);
+        ffStrbufAppendUInt(buffer, *(uint32_t*)formatarg->value);
     else if(formatarg->type == FF_FORMAT_ARG_TYPE_UINT16)
-        ffStrbufAppendF(buffer, "%" PRIu16, *(uint16_t*)formatarg->value);
+        ffStrbufAppendUInt(buffer, *(uint16_t*)formatarg->value);
     else if(formatarg->type == FF_FORMAT_ARG_TYPE_UINT8)
-        ffStrbufAppendF(buffer, "%" PRIu8, *(uint8_t*)formatarg->value);
+        ffStrbufAppendUInt(buffer, *(uint8_t*)formatarg->value);
     else if(formatarg->type == FF_FORMAT_ARG_TYPE_STRING)
         ffStrbufAppendS(buffer, (const char*)formatarg->value);
     else if(formatarg->type == FF_FORMAT_ARG_TYPE_STRBUF)
         ffStrbufAppend(buffer, (FFstrbuf*)formatarg->value);
     else if(formatarg->type == FF_FORMAT_ARG_TYPE_FLOAT)
-        ffStrbufAppendF(buffer, "%f", *(float*)formatarg->value);
+        ffStrbufAppendDouble(buffer, *(float*)formatarg->value, 6);
     else if(formatarg->type == FF_FORMAT_ARG_TYPE_DOUBLE)
-        ffStrbufAppendF(buffer, "%g", *(double*)formatarg->value);
+        ffStrbufAppendDouble(buffer, *(double*)formatarg->value, -1);
     else if(formatarg->type == FF_FORMAT_ARG_TYPE_BOOL)
         ffStrbufAppendS(buffer, formatarg->value != NULL ? "true" : "false");
     else if(formatarg->type == FF_FORMAT_ARG_TYPE_LIST)
@@ -60,25 +58,6 @@ static inline uint32_t getArgumentIndex(const FFstrbuf* placeholderValue)
     return result == 0 ? UINT32_MAX : result;
 }
 
-static inline void appendInvalidPlaceholder(FFstrbuf* buffer, const char* start, const FFstrbuf* placeholderValue, uint32_t index, uint32_t formatStringLength)
-{
-    ffStrbufAppendS(buffer, start);
-    ffStrbufAppend(buffer, placeholderValue);
-
-    if(index < formatStringLength)
-        ffStrbufAppendC(buffer, '}');
-}
-
-static inline void appendEmptyPlaceholder(FFstrbuf* buffer, const char* placeholder, uint32_t* argCounter, uint32_t numArgs, const FFformatarg* arguments)
-{
-    if(*argCounter >= numArgs)
-        ffStrbufAppendS(buffer, placeholder);
-    else
-        ffFormatAppendFormatArg(buffer, arguments + *argCounter);
-
-    (*argCounter)++;
-}
-
 static inline bool formatArgSet(const FFformatarg* arg)
 {
     return arg->value != NULL && (
@@ -93,185 +72,257 @@ static inline bool formatArgSet(const FFformatarg* arg)
     );
 }
 
-void ffParseFormatString(FFstrbuf* buffer, const FFstrbuf* formatstr, uint32_t numArgs, const FFformatarg* arguments)
+typedef enum FFformatOpType
 {
-    uint32_t argCounter = 0;
+    FF_FORMAT_OP_LITERAL, // Appends the span
+    FF_FORMAT_OP_NEXT_ARG, // {}: appends the next argument, or the span if there is none
+    FF_FORMAT_OP_ARG, // {n}
+    FF_FORMAT_OP_IF, // {?n}: continues at jump if argument n is not set
+    FF_FORMAT_OP_NOT_IF, // {/n}: continues at jump if argument n is set
+    FF_FORMAT_OP_END_IF, // {?}
+    FF_FORMAT_OP_END_NOT_IF, // {/}
+    FF_FORMAT_OP_COLOR, // {#...}: the span is the color value
+    FF_FORMAT_OP_END_COLOR, // {#}
+    FF_FORMAT_OP_STOP, // {-}
+} FFformatOpType;
+
+typedef struct FFformatOp
+{
+    FFformatOpType type;
+    uint32_t start; // Span in the format string. Unless noted otherwise, this is the whole placeholder, which is printed as is if it is invalid
+    uint32_t length;
+    uint32_t index; // Argument index, starting at 1. UINT32_MAX if it isn't a valid number
+    uint32_t jump; // Op index for IF and NOT_IF. While compiling, the position in the format string instead
+} FFformatOp;
+
+typedef struct FFformatCompiled
+{
+    const FFstrbuf* formatstr;
+    const char* chars; // To detect that formatstr was changed after it was compiled
+    uint32_t length;
+    FFlist ops;
+} FFformatCompiled;
 
-    uint32_t numOpenIfs = 0;
-    uint32_t numOpenNotIfs = 0;
-    uint32_t numOpenColors = 0;
+static FFlist compiledFormats = { .elementSize = sizeof(FFformatCompiled) };
+
+static inline void addOp(FFlist* ops, FFlist* positions, uint32_t position, FFformatOpType type, uint32_t start, uint32_t length)
+{
+    FFformatOp* op = ffListAdd(ops);
+    op->type = type;
+    op->start = start;
+    op->length = length;
+    op->index = UINT32_MAX;
+    op->jump = 0;
+    *(uint32_t*) ffListAdd(positions) = position;
+}
+
+// Splits the format string into ops, which behave exactly like parsing it character by character
+static void compileFormat(const FFstrbuf* formatstr, FFlist* ops)
+{
+    // Position of every op in the format string, to resolve the jumps
+    FF_LIST_AUTO_DESTROY positions;
+    ffListInitA(&positions, sizeof(uint32_t), 16);
+
+    FFstrbuf placeholderValue;
+    ffStrbufInit(&placeholderValue);
 
-    for(uint32_t i = 0; i < formatstr->length; ++i)
+    uint32_t i = 0;
+    while(i < formatstr->length)
     {
-        // if we don't have a placeholder start just copy the chars over to output buffer
         if(formatstr->chars[i] != '{')
         {
-            ffStrbufAppendC(buffer, formatstr->chars[i]);
+            // Jumps always end behind a '}', so literals are split there
+            uint32_t end = i;
+            while(end < formatstr->length && formatstr->chars[end] != '{' && formatstr->chars[end++] != '}');
+            addOp(ops, &positions, i, FF_FORMAT_OP_LITERAL, i, end - i);
+            i = end;
             continue;
         }
 
         // if we have an { at the end handle it as {}
         if(i == formatstr->length - 1)
         {
-            appendEmptyPlaceholder(buffer, "{", &argCounter, numArgs, arguments);
-            continue;
+            addOp(ops, &positions, i, FF_FORMAT_OP_NEXT_ARG, i, 1);
+            break;
         }
 
-        // jump to next char, the start of the placeholder value
-        ++i;
-
         // double {{ elvaluates to a single { and doesn't count as start
-        if(formatstr->chars[i] == '{')
+        if(formatstr->chars[i + 1] == '{')
         {
-            ffStrbufAppendC(buffer, '{');
+            addOp(ops, &positions, i, FF_FORMAT_OP_LITERAL, i + 1, 1);
+            i += 2;
             continue;
         }
 
         // placeholder is {}
-        if(formatstr->chars[i] == '}')
+        if(formatstr->chars[i + 1] == '}')
         {
-            appendEmptyPlaceholder(buffer, "{}", &argCounter, numArgs, arguments);
+            addOp(ops, &positions, i, FF_FORMAT_OP_NEXT_ARG, i, 2);
+            i += 2;
             continue;
         }
 
-        FFstrbuf placeholderValue;
-        ffStrbufInit(&placeholderValue);
-
-        while(i < formatstr->length && formatstr->chars[i] != '}')
-            ffStrbufAppendC(&placeholderValue, formatstr->chars[i++]);
-
-         // test if for stop, if so break the loop
-        if(placeholderValue.length == 1 && placeholderValue.chars[0] == '-')
+        uint32_t valueStart = i + 1;
+        uint32_t valueEnd = valueStart;
+        while(valueEnd < formatstr->length && formatstr->chars[valueEnd] != '}')
+            ++valueEnd;
+
+        uint32_t start = i;
+        uint32_t length = valueEnd - start + (valueEnd < formatstr->length);
+        char first = formatstr->chars[valueStart];
+        ffStrbufSetNS(&placeholderValue, valueEnd - valueStart, formatstr->chars + valueStart);
+        i = start + length;
+
+        // Ops behind it are still needed, conditionals can jump over it
+        if(placeholderValue.length == 1 && first == '-')
+            addOp(ops, &positions, start, FF_FORMAT_OP_STOP, start, length);
+        else if(placeholderValue.length == 1 && first == '?')
+            addOp(ops, &positions, start, FF_FORMAT_OP_END_IF, start, length);
+        else if(placeholderValue.length == 1 && first == '/')
+            addOp(ops, &positions, start, FF_FORMAT_OP_END_NOT_IF, start, length);
+        else if(placeholderValue.length == 1 && first == '#')
+            addOp(ops, &positions, start, FF_FORMAT_OP_END_COLOR, start, length);
+        else if(first == '?' || first == '/')
         {
-            ffStrbufDestroy(&placeholderValue);
-            break;
-        }
+            addOp(ops, &positions, start, first == '?' ? FF_FORMAT_OP_IF : FF_FORMAT_OP_NOT_IF, start, length);
 
-        // test for end of an if, if so do nothing
-        if(placeholderValue.length == 1 && placeholderValue.chars[0] == '?')
-        {
-            if(numOpenIfs == 0)
-                appendInvalidPlaceholder(buffer, "{", &placeholderValue, i, formatstr->length);
-            else
-                --numOpenIfs;
+            // If the condition is false, everything until behind the next end marker is skipped, regardless of nesting
+            uint32_t end = ffStrbufNextIndexS(formatstr, valueEnd, first == '?' ? "{?}" : "{/}");
+            FFformatOp* op = ffListGet(ops, ops->length - 1);
+            op->jump = end < formatstr->length ? end + 3 : formatstr->length;
 
-            ffStrbufDestroy(&placeholderValue);
-            continue;
+            ffStrbufSubstrAfter(&placeholderValue, 0);
+            op->index = getArgumentIndex(&placeholderValue);
         }
-
-        // test for end of a not if, if so do nothing
-        if(placeholderValue.length == 1 && placeholderValue.chars[0] == '/')
+        else if(first == '#')
+            addOp(ops, &positions, start, FF_FORMAT_OP_COLOR, valueStart + 1, valueEnd - valueStart - 1);
+        else
         {
-            if(numOpenNotIfs == 0)
-                appendInvalidPlaceholder(buffer, "{", &placeholderValue, i, formatstr->length);
-            else
-                --numOpenNotIfs;
-
-            ffStrbufDestroy(&placeholderValue);
-            continue;
+            addOp(ops, &positions, start, FF_FORMAT_OP_ARG, start, length);
+            ((FFformatOp*) ffListGet(ops, ops->length - 1))->index = getArgumentIndex(&placeholderValue);
         }
+    }
 
-        // test for end of a color, if so do nothing
-        if(placeholderValue.length == 1 && placeholderValue.chars[0] == '#')
-        {
-            if(numOpenColors == 0)
-                appendInvalidPlaceholder(buffer, "{", &placeholderValue, i, formatstr->length);
-            else
-            {
-                ffStrbufAppendS(buffer, FASTFETCH_TEXT_MODIFIER_RESET);
-                --numOpenColors;
-            }
+    ffStrbufDestroy(&placeholderValue);
 
-            ffStrbufDestroy(&placeholderValue);
+    // Resolve the positions of the jumps to op indexes. Positions are ascending, and every jump target starts an op
+    for(uint32_t opIndex = 0; opIndex < ops->length; ++opIndex)
+    {
+        FFformatOp* op = ffListGet(ops, opIndex);
+        if(op->type != FF_FORMAT_OP_IF && op->type != FF_FORMAT_OP_NOT_IF)
             continue;
-        }
-
-        // test for if, if so evaluate it
-        if(placeholderValue.chars[0] == '?')
-        {
-            ffStrbufSubstrAfter(&placeholderValue, 0);
 
-            uint32_t index = getArgumentIndex(&placeholderValue);
-
-            // testing for an invalid index
-            if(index > numArgs)
-            {
-                appendInvalidPlaceholder(buffer, "{?", &placeholderValue, i, formatstr->length);
-                ffStrbufDestroy(&placeholderValue);
-                continue;
-            }
+        uint32_t target = opIndex + 1;
+        while(target < ops->length && *(uint32_t*) ffListGet(&positions, target) < op->jump)
+            ++target;
+        op->jump = target;
+    }
+}
 
-            // continue normally if an format arg is set and the value is > 0
-            if(formatArgSet(&arguments[index - 1]))
-            {
-                ++numOpenIfs;
-                ffStrbufDestroy(&placeholderValue);
-                continue;
-            }
+static void executeFormat(FFstrbuf* buffer, const char* chars, const FFlist* ops, uint32_t numArgs, const FFformatarg* arguments)
+{
+    uint32_t argCounter = 0;
 
-            // fastforward to the end of the if without printing the in between
-            i = ffStrbufNextIndexS(formatstr, i, "{?}") + 2; // 2 is the length of "{?}" - 1 because the loop will increament it again directly after continue
-            ffStrbufDestroy(&placeholderValue);
-            continue;
-        }
+    uint32_t numOpenIfs = 0;
+    uint32_t numOpenNotIfs = 0;
+    uint32_t numOpenColors = 0;
 
-        // test for not if, if so evaluate it
-        if(placeholderValue.chars[0] == '/')
+    for(uint32_t i = 0; i < ops->length; ++i)
+    {
+        const FFformatOp* op = ffListGet(ops, i);
+        switch(op->type)
         {
-            ffStrbufSubstrAfter(&placeholderValue, 0);
-
-            uint32_t index = getArgumentIndex(&placeholderValue);
-
-            // testing for an invalid index
-            if(index > numArgs)
+            case FF_FORMAT_OP_LITERAL:
+                ffStrbufAppendNS(buffer, op->length, chars + op->start);
+                break;
+            case FF_FORMAT_OP_NEXT_ARG:
+                if(argCounter >= numArgs)
+                    ffStrbufAppendNS(buffer, op->length, chars + op->start);
+                else
+                    ffFormatAppendFormatArg(buffer, arguments + argCounter);
+                ++argCounter;
+                break;
+            case FF_FORMAT_OP_ARG:
+                if(op->index > numArgs)
+                    ffStrbufAppendNS(buffer, op->length, chars + op->start);
+                else
+                    ffFormatAppendFormatArg(buffer, &arguments[op->index - 1]);
+                break;
+            case FF_FORMAT_OP_IF:
+            case FF_FORMAT_OP_NOT_IF:
+                if(op->index > numArgs)
+                    ffStrbufAppendNS(buffer, op->length, chars + op->start);
+                else if(formatArgSet(&arguments[op->index - 1]) == (op->type == FF_FORMAT_OP_IF))
+                    ++*(op->type == FF_FORMAT_OP_IF ? &numOpenIfs : &numOpenNotIfs);
+                else
+                    i = op->jump - 1; // the loop increments it again
+                break;
+            case FF_FORMAT_OP_END_IF:
+            case FF_FORMAT_OP_END_NOT_IF:
             {
-                appendInvalidPlaceholder(buffer, "{/", &placeholderValue, i, formatstr->length);
-                ffStrbufDestroy(&placeholderValue);
-                continue;
+                uint32_t* numOpen = op->type == FF_FORMAT_OP_END_IF ? &numOpenIfs : &numOpenNotIfs;
+                if(*numOpen == 0)
+                    ffStrbufAppendNS(buffer, op->length, chars + op->start);
+                else
+                    --*numOpen;
+                break;
             }
+            case FF_FORMAT_OP_COLOR:
+                ++numOpenColors;
+                ffStrbufAppendS(buffer, "\033[");
+                ffStrbufAppendNS(buffer, op->length, chars + op->start);
+                ffStrbufAppendC(buffer, 'm');
+                break;
+            case FF_FORMAT_OP_END_COLOR:
+                if(numOpenColors == 0)
+                    ffStrbufAppendNS(buffer, op->length, chars + op->start);
+                else
+                {
+                    ffStrbufAppendS(buffer, FASTFETCH_TEXT_MODIFIER_RESET);
+                    --numOpenColors;
+                }
+                break;
+            case FF_FORMAT_OP_STOP:
+                i = ops->length;
+                break;
+        }
+    }
 
-            //continue normally if an format arg is not set or the value is 0
-            if(!formatArgSet(&arguments[index - 1]))
-            {
-                ++numOpenNotIfs;
-                ffStrbufDestroy(&placeholderValue);
-                continue;
-            }
+    ffStrbufTrimRight(buffer, ' ');
 
-            // fastforward to the end of the if without printing the in between
-            i = ffStrbufNextIndexS(formatstr, i, "{/}") + 2; // 2 is the length of "{/}" - 1 because the loop will increament it again directly after continue
-            ffStrbufDestroy(&placeholderValue);
-            continue;
-        }
+    ffStrbufAppendS(buffer, FASTFETCH_TEXT_MODIFIER_RESET);
+}
 
-        //test for color, if so evaluate it
-        if(placeholderValue.chars[0] == '#')
-        {
-            ++numOpenColors;
-            ffStrbufSubstrAfter(&placeholderValue, 0);
-            ffStrbufAppendS(buffer, "\033[");
-            ffStrbufAppend(buffer, &placeholderValue);
-            ffStrbufAppendC(buffer, 'm');
-            ffStrbufDestroy(&placeholderValue);
-            continue;
-        }
+void ffFormatCompile(const FFstrbuf* formatstr)
+{
+    FFformatCompiled* compiled = ffListAdd(&compiledFormats);
+    compiled->formatstr = formatstr;
+    compiled->chars = formatstr->chars;
+    compiled->length = formatstr->length;
+    ffListInit(&compiled->ops, sizeof(FFformatOp));
+    compileFormat(formatstr, &compiled->ops);
+}
 
-        uint32_t index = getArgumentIndex(&placeholderValue);
+void ffFormatDestroyCompiled(void)
+{
+    FF_LIST_FOR_EACH(FFformatCompiled, compiled, compiledFormats)
+        ffListDestroy(&compiled->ops);
+    ffListDestroy(&compiledFormats);
+}
 
-        // test for invalid index
-        if(index > numArgs)
+void ffParseFormatString(FFstrbuf* buffer, const FFstrbuf* formatstr, uint32_t numArgs, const FFformatarg* arguments)
+{
+    FF_LIST_FOR_EACH(FFformatCompiled, compiled, compiledFormats)
+    {
+        if(compiled->formatstr == formatstr && compiled->chars == formatstr->chars && compiled->length == formatstr->length)
         {
-            appendInvalidPlaceholder(buffer, "{", &placeholderValue, i, formatstr->length);
-            ffStrbufDestroy(&placeholderValue);
-            continue;
+            executeFormat(buffer, formatstr->chars, &compiled->ops, numArgs, arguments);
+            return;
         }
-
-        ffFormatAppendFormatArg(buffer, &arguments[index - 1]);
-
-        ffStrbufDestroy(&placeholderValue);
     }
 
-    ffStrbufTrimRight(buffer, ' ');
-
-    ffStrbufAppendS(buffer, FASTFETCH_TEXT_MODIFIER_RESET);
+    FF_LIST_AUTO_DESTROY ops;
+    ffListInit(&ops, sizeof(FFformatOp));
+    compileFormat(formatstr, &ops);
+    executeFormat(buffer, formatstr->chars, &ops, numArgs, arguments);
 }
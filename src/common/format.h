@@ -27,6 +27,10 @@ typedef struct FFformatarg
 void ffFormatAppendFormatArg(FFstrbuf* buffer, const FFformatarg* formatarg);
 void ffParseFormatString(FFstrbuf* buffer, const FFstrbuf* formatstr, uint32_t numArgs, const FFformatarg* arguments);
 
+// Splits a format string, which must not change anymore, into ops once. ffParseFormatString then runs them instead of parsing it again
+void ffFormatCompile(const FFstrbuf* formatstr);
+void ffFormatDestroyCompiled(void);
+
 #define FF_FORMAT_ARG_VALUE_BOOL(xpr) ((xpr) ? (const void*) 1 : NULL)
 
 #endif
@@ -1,4 +1,5 @@
 #include "fastfetch.h"
+#include "common/modules.h"
 #include "common/parsing.h"
 #include "common/thread.h"
 #include "detection/displayserver/displayserver.h"
@@ -21,23 +22,25 @@ static void initState(FFstate* state)
     state->logoWidth = 0;
     state->logoHeight = 0;
     state->keysHeight = 0;
+    ffStrbufInit(&state->logoRows);
+    ffListInit(&state->logoRowInfos, sizeof(FFLogoRow));
 
     ffPlatformInit(&state->platform);
 }
 
 static void initModuleArg(FFModuleArgs* args)
 {
-    ffStrbufInit(&args->key);
-    ffStrbufInit(&args->outputFormat);
-    ffStrbufInit(&args->errorFormat);
+    ffStrbufInitArena(&args->key);
+    ffStrbufInitArena(&args->outputFormat);
+    ffStrbufInitArena(&args->errorFormat);
 }
 
 static void defaultConfig(FFinstance* instance)
 {
-    ffStrbufInitA(&instance->config.logo.source, 0);
+    ffStrbufInitArena(&instance->config.logo.source);
     instance->config.logo.type = FF_LOGO_TYPE_AUTO;
     for(uint8_t i = 0; i < (uint8_t) FASTFETCH_LOGO_MAX_COLORS; ++i)
-        ffStrbufInit(&instance->config.logo.colors[i]);
+        ffStrbufInitArena(&instance->config.logo.colors[i]);
     instance->config.logo.width = 0;
     instance->config.logo.height = 0; //preserve aspect ratio
     instance->config.logo.paddingTop = 0;
@@ -47,15 +50,15 @@ static void defaultConfig(FFinstance* instance)
     instance->config.logo.preserveAspectRadio = false;
 
     instance->config.logo.chafaFgOnly = false;
-    ffStrbufInitS(&instance->config.logo.chafaSymbols, "block+border+space-wide-inverted"); // Chafa default
+    ffStrbufInitArenaS(&instance->config.logo.chafaSymbols, "block+border+space-wide-inverted"); // Chafa default
     instance->config.logo.chafaCanvasMode = UINT32_MAX;
     instance->config.logo.chafaColorSpace = UINT32_MAX;
     instance->config.logo.chafaDitherMode = UINT32_MAX;
 
-    ffStrbufInit(&instance->config.colorKeys);
-    ffStrbufInit(&instance->config.colorTitle);
+    ffStrbufInitArena(&instance->config.colorKeys);
+    ffStrbufInitArena(&instance->config.colorTitle);
 
-    ffStrbufInit(&instance->config.separator);
+    ffStrbufInitArena(&instance->config.separator);
     ffStrbufAppendS(&instance->config.separator, ": ");
 
     instance->config.showErrors = false;
@@ -70,78 +73,40 @@ static void defaultConfig(FFinstance* instance)
     instance->config.multithreading = true;
     instance->config.stat = false;
 
-    initModuleArg(&instance->config.os);
-    initModuleArg(&instance->config.host);
-    initModuleArg(&instance->config.bios);
-    initModuleArg(&instance->config.board);
-    initModuleArg(&instance->config.brightness);
-    initModuleArg(&instance->config.chassis);
-    initModuleArg(&instance->config.kernel);
-    initModuleArg(&instance->config.uptime);
-    initModuleArg(&instance->config.processes);
-    initModuleArg(&instance->config.packages);
-    initModuleArg(&instance->config.shell);
-    initModuleArg(&instance->config.display);
-    initModuleArg(&instance->config.de);
-    initModuleArg(&instance->config.wm);
-    initModuleArg(&instance->config.wmTheme);
-    initModuleArg(&instance->config.theme);
-    initModuleArg(&instance->config.icons);
-    initModuleArg(&instance->config.font);
-    initModuleArg(&instance->config.cursor);
-    initModuleArg(&instance->config.terminal);
-    initModuleArg(&instance->config.terminalFont);
-    initModuleArg(&instance->config.cpu);
-    initModuleArg(&instance->config.cpuUsage);
-    initModuleArg(&instance->config.gpu);
-    initModuleArg(&instance->config.memory);
-    initModuleArg(&instance->config.swap);
-    initModuleArg(&instance->config.disk);
-    initModuleArg(&instance->config.battery);
-    initModuleArg(&instance->config.powerAdapter);
-    initModuleArg(&instance->config.locale);
-    initModuleArg(&instance->config.localIP);
-    initModuleArg(&instance->config.publicIP);
-    initModuleArg(&instance->config.weather);
-    initModuleArg(&instance->config.wifi);
-    initModuleArg(&instance->config.player);
-    initModuleArg(&instance->config.media);
-    initModuleArg(&instance->config.dateTime);
-    initModuleArg(&instance->config.date);
-    initModuleArg(&instance->config.time);
-    initModuleArg(&instance->config.vulkan);
-    initModuleArg(&instance->config.openGL);
-    initModuleArg(&instance->config.openCL);
-    initModuleArg(&instance->config.users);
-    initModuleArg(&instance->config.bluetooth);
-    initModuleArg(&instance->config.sound);
-    initModuleArg(&instance->config.gamepad);
-
-    ffStrbufInitA(&instance->config.libPCI, 0);
-    ffStrbufInitA(&instance->config.libVulkan, 0);
-    ffStrbufInitA(&instance->config.libWayland, 0);
-    ffStrbufInitA(&instance->config.libXcbRandr, 0);
-    ffStrbufInitA(&instance->config.libXcb, 0);
-    ffStrbufInitA(&instance->config.libXrandr, 0);
-    ffStrbufInitA(&instance->config.libX11, 0);
-    ffStrbufInitA(&instance->config.libGIO, 0);
-    ffStrbufInitA(&instance->config.libDConf, 0);
-    ffStrbufInitA(&instance->config.libDBus, 0);
-    ffStrbufInitA(&instance->config.libXFConf, 0);
-    ffStrbufInitA(&instance->config.libSQLite3, 0);
-    ffStrbufInitA(&instance->config.librpm, 0);
-    ffStrbufInitA(&instance->config.libImageMagick, 0);
-    ffStrbufInitA(&instance->config.libZ, 0);
-    ffStrbufInitA(&instance->config.libChafa, 0);
-    ffStrbufInitA(&instance->config.libEGL, 0);
-    ffStrbufInitA(&instance->config.libGLX, 0);
-    ffStrbufInitA(&instance->config.libOSMesa, 0);
-    ffStrbufInitA(&instance->config.libOpenCL, 0);
-    ffStrbufInitA(&instance->config.libJSONC, 0);
-    ffStrbufInitA(&instance->config.libfreetype, 0);
-    ffStrbufInit(&instance->config.libPulse);
-    ffStrbufInit(&instance->config.libwlanapi);
-    ffStrbufInit(&instance->config.libnm);
+    for(uint32_t i = 0; i < ffModulesCount; ++i)
+    {
+        FFModuleArgs* args = ffModuleGetArgs(&instance->config, &ffModules[i]);
+        if(args != NULL)
+            initModuleArg(args);
+    }
+
+    ffStrbufInitArena(&instance->config.libPCI);
+    ffStrbufInitArena(&instance->config.libVulkan);
+    ffStrbufInitArena(&instance->config.libWayland);
+    ffStrbufInitArena(&instance->config.libXcbRandr);
+    ffStrbufInitArena(&instance->config.libXcb);
+    ffStrbufInitArena(&instance->config.libXrandr);
+    ffStrbufInitArena(&instance->config.libX11);
+    ffStrbufInitArena(&instance->config.libGIO);
+    ffStrbufInitArena(&instance->config.libDConf);
+    ffStrbufInitArena(&instance->config.libDBus);
+    ffStrbufInitArena(&instance->config.libXFConf);
+    ffStrbufInitArena(&instance->config.libSQLite3);
+    ffStrbufInitArena(&instance->config.librpm);
+    ffStrbufInitArena(&instance->config.libImageMagick);
+    ffStrbufInitArena(&instance->config.libZ);
+    ffStrbufInitArena(&instance->config.libChafa);
+    ffStrbufInitArena(&instance->config.libEGL);
+    ffStrbufInitArena(&instance->config.libGLX);
+    ffStrbufInitArena(&instance->config.libOSMesa);
+    ffStrbufInitArena(&instance->config.libOpenCL);
+    ffStrbufInitArena(&instance->config.libJSONC);
+    ffStrbufInitArena(&instance->config.libfreetype);
+    ffStrbufInitArena(&instance->config.libPulse);
+    ffStrbufInitArena(&instance->config.libwlanapi);
+    ffStrbufInitArena(&instance->config.libnm);
+
+    instance->config.cpuUsageMinInterval = 200;
 
     instance->config.cpuTemp = false;
     instance->config.gpuTemp = false;
@@ -155,7 +120,7 @@ static void defaultConfig(FFinstance* instance)
 
     instance->config.titleFQDN = false;
 
-    ffStrbufInitA(&instance->config.diskFolders, 0);
+    ffStrbufInitArena(&instance->config.diskFolders);
     instance->config.diskShowRemovable = true;
     instance->config.diskShowHidden = false;
     instance->config.diskShowUnknown = false;
@@ -165,30 +130,30 @@ static void defaultConfig(FFinstance* instance)
 
     instance->config.soundType = FF_SOUND_TYPE_MAIN;
 
-    ffStrbufInitA(&instance->config.batteryDir, 0);
+    ffStrbufInitArena(&instance->config.batteryDir);
 
-    ffStrbufInitA(&instance->config.separatorString, 0);
+    ffStrbufInitArena(&instance->config.separatorString);
 
     instance->config.localIpShowIpV4 = true;
     instance->config.localIpShowIpV6 = false;
     instance->config.localIpShowLoop = false;
     instance->config.localIpV6First = false;
-    ffStrbufInit(&instance->config.localIpNamePrefix);
+    ffStrbufInitArena(&instance->config.localIpNamePrefix);
     instance->config.localIpCompactType = FF_LOCALIP_COMPACT_TYPE_NONE;
 
     instance->config.publicIpTimeout = 0;
-    ffStrbufInit(&instance->config.publicIpUrl);
+    ffStrbufInitArena(&instance->config.publicIpUrl);
 
     instance->config.weatherTimeout = 0;
-    ffStrbufInitS(&instance->config.weatherOutputFormat, "%t+-+%C+(%l)");
+    ffStrbufInitArenaS(&instance->config.weatherOutputFormat, "%t+-+%C+(%l)");
 
-    ffStrbufInitA(&instance->config.osFile, 0);
+    ffStrbufInitArena(&instance->config.osFile);
 
-    ffStrbufInitA(&instance->config.playerName, 0);
+    ffStrbufInitArena(&instance->config.playerName);
 
     instance->config.percentType = 1;
 
-    ffStrbufInitS(&instance->config.commandShell,
+    ffStrbufInitArenaS(&instance->config.commandShell,
         #ifdef _WIN32
         "cmd"
         #elif defined(__FreeBSD__)
@@ -197,8 +162,8 @@ static void defaultConfig(FFinstance* instance)
         "bash"
         #endif
     );
-    ffListInit(&instance->config.commandKeys, sizeof(FFstrbuf));
-    ffListInit(&instance->config.commandTexts, sizeof(FFstrbuf));
+    ffListInitArena(&instance->config.commandKeys, sizeof(FFstrbuf));
+    ffListInitArena(&instance->config.commandTexts, sizeof(FFstrbuf));
 }
 
 void ffInitInstance(FFinstance* instance)
@@ -335,50 +300,12 @@ static void destroyConfig(FFinstance* instance)
     ffStrbufDestroy(&instance->config.colorTitle);
     ffStrbufDestroy(&instance->config.separator);
 
-    destroyModuleArg(&instance->config.os);
-    destroyModuleArg(&instance->config.host);
-    destroyModuleArg(&instance->config.bios);
-    destroyModuleArg(&instance->config.board);
-    destroyModuleArg(&instance->config.kernel);
-    destroyModuleArg(&instance->config.uptime);
-    destroyModuleArg(&instance->config.processes);
-    destroyModuleArg(&instance->config.packages);
-    destroyModuleArg(&instance->config.shell);
-    destroyModuleArg(&instance->config.display);
-    destroyModuleArg(&instance->config.de);
-    destroyModuleArg(&instance->config.wm);
-    destroyModuleArg(&instance->config.wmTheme);
-    destroyModuleArg(&instance->config.theme);
-    destroyModuleArg(&instance->config.icons);
-    destroyModuleArg(&instance->config.font);
-    destroyModuleArg(&instance->config.cursor);
-    destroyModuleArg(&instance->config.terminal);
-    destroyModuleArg(&instance->config.terminalFont);
-    destroyModuleArg(&instance->config.cpu);
-    destroyModuleArg(&instance->config.cpuUsage);
-    destroyModuleArg(&instance->config.gpu);
-    destroyModuleArg(&instance->config.memory);
-    destroyModuleArg(&instance->config.swap);
-    destroyModuleArg(&instance->config.disk);
-    destroyModuleArg(&instance->config.battery);
-    destroyModuleArg(&instance->config.powerAdapter);
-    destroyModuleArg(&instance->config.locale);
-    destroyModuleArg(&instance->config.localIP);
-    destroyModuleArg(&instance->config.publicIP);
-    destroyModuleArg(&instance->config.weather);
-    destroyModuleArg(&instance->config.wifi);
-    destroyModuleArg(&instance->config.player);
-    destroyModuleArg(&instance->config.media);
-    destroyModuleArg(&instance->config.dateTime);
-    destroyModuleArg(&instance->config.date);
-    destroyModuleArg(&instance->config.time);
-    destroyModuleArg(&instance->config.vulkan);
-    destroyModuleArg(&instance->config.openGL);
-    destroyModuleArg(&instance->config.openCL);
-    destroyModuleArg(&instance->config.users);
-    destroyModuleArg(&instance->config.bluetooth);
-    destroyModuleArg(&instance->config.sound);
-    destroyModuleArg(&instance->config.gamepad);
+    for(uint32_t i = 0; i < ffModulesCount; ++i)
+    {
+        FFModuleArgs* args = ffModuleGetArgs(&instance->config, &ffModules[i]);
+        if(args != NULL)
+            destroyModuleArg(args);
+    }
 
     ffStrbufDestroy(&instance->config.libPCI);
     ffStrbufDestroy(&instance->config.libVulkan);
@@ -426,6 +353,8 @@ static void destroyConfig(FFinstance* instance)
 
 static void destroyState(FFinstance* instance)
 {
+    ffStrbufDestroy(&instance->state.logoRows);
+    ffListDestroy(&instance->state.logoRowInfos);
     ffPlatformDestroy(&instance->state.platform);
 }
 
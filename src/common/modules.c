@@ -0,0 +1,116 @@
+#include "fastfetch.h"
+#include "common/modules.h"
+
+#include <ctype.h>
+#include <strings.h>
+
+// Chosen so that no two names or aliases of ffModules share a slot
+#define FF_MODULE_HASH_SEED 0x40ECFu
+
+static void prepareCPUUsage(FFinstance* instance)
+{
+    FF_UNUSED(instance);
+    ffPrepareCPUUsage();
+}
+
+static void prepareDiskIO(FFinstance* instance)
+{
+    FF_UNUSED(instance);
+    ffPrepareDiskIO();
+}
+
+const FFModuleInfo ffModules[] = {
+    { "Break", NULL, NULL, FF_MODULE_ARGS_NONE, ffPrintBreak, NULL, false },
+    { "Title", NULL, NULL, FF_MODULE_ARGS_NONE, ffPrintTitle, NULL, false },
+    { "Separator", NULL, NULL, FF_MODULE_ARGS_NONE, ffPrintSeparator, NULL, false },
+    { "OS", NULL, "os", offsetof(FFconfig, os), ffPrintOS, NULL, false },
+    { "Host", NULL, "host", offsetof(FFconfig, host), ffPrintHost, NULL, false },
+    { "Bios", NULL, "bios", offsetof(FFconfig, bios), ffPrintBios, NULL, false },
+    { "Board", NULL, "board", offsetof(FFconfig, board), ffPrintBoard, NULL, false },
+    { "Brightness", NULL, "brightness", offsetof(FFconfig, brightness), ffPrintBrightness, NULL, false },
+    { "Chassis", NULL, "chassis", offsetof(FFconfig, chassis), ffPrintChassis, NULL, false },
+    { "Kernel", NULL, "kernel", offsetof(FFconfig, kernel), ffPrintKernel, NULL, false },
+    { "Uptime", NULL, "uptime", offsetof(FFconfig, uptime), ffPrintUptime, NULL, false },
+    { "Processes", NULL, "processes", offsetof(FFconfig, processes), ffPrintProcesses, NULL, false },
+    { "Packages", NULL, "packages", offsetof(FFconfig, packages), ffPrintPackages, NULL, false },
+    { "Shell", NULL, "shell", offsetof(FFconfig, shell), ffPrintShell, NULL, false },
+    { "Display", NULL, "display", offsetof(FFconfig, display), ffPrintDisplay, NULL, false },
+    { "DesktopEnvironment", "DE", "de", offsetof(FFconfig, de), ffPrintDesktopEnvironment, NULL, false },
+    { "WindowManager", "WM", "wm", offsetof(FFconfig, wm), ffPrintWM, NULL, false },
+    { "Theme", NULL, "theme", offsetof(FFconfig, theme), ffPrintTheme, NULL, false },
+    { "WMTheme", NULL, "wm-theme", offsetof(FFconfig, wmTheme), ffPrintWMTheme, NULL, false },
+    { "Icons", NULL, "icons", offsetof(FFconfig, icons), ffPrintIcons, NULL, false },
+    { "Font", NULL, "font", offsetof(FFconfig, font), ffPrintFont, NULL, false },
+    { "Cursor", NULL, "cursor", offsetof(FFconfig, cursor), ffPrintCursor, NULL, false },
+    { "Terminal", NULL, "terminal", offsetof(FFconfig, terminal), ffPrintTerminal, NULL, false },
+    { "TerminalFont", NULL, "terminal-font", offsetof(FFconfig, terminalFont), ffPrintTerminalFont, NULL, false },
+    { "CPU", NULL, "cpu", offsetof(FFconfig, cpu), ffPrintCPU, NULL, false },
+    { "CPUUsage", NULL, "cpu-usage", offsetof(FFconfig, cpuUsage), ffPrintCPUUsage, prepareCPUUsage, false },
+    { "GPU", NULL, "gpu", offsetof(FFconfig, gpu), ffPrintGPU, NULL, false },
+    { "Memory", NULL, "memory", offsetof(FFconfig, memory), ffPrintMemory, NULL, false },
+    { "Swap", NULL, "swap", offsetof(FFconfig, swap), ffPrintSwap, NULL, false },
+    { "Disk", NULL, "disk", offsetof(FFconfig, disk), ffPrintDisk, NULL, false },
+    { "DiskIO", NULL, "disk-io", offsetof(FFconfig, diskIO), ffPrintDiskIO, prepareDiskIO, false },
+    { "Battery", NULL, "battery", offsetof(FFconfig, battery), ffPrintBattery, NULL, false },
+    { "PowerAdapter", NULL, "poweradapter", offsetof(FFconfig, powerAdapter), ffPrintPowerAdapter, NULL, false },
+    { "Locale", NULL, "locale", offsetof(FFconfig, locale), ffPrintLocale, NULL, false },
+    { "LocalIP", NULL, "local-ip", offsetof(FFconfig, localIP), ffPrintLocalIp, NULL, false },
+    { "PublicIP", NULL, "public-ip", offsetof(FFconfig, publicIP), ffPrintPublicIp, ffPreparePublicIp, true },
+    { "Wifi", NULL, "wifi", offsetof(FFconfig, wifi), ffPrintWifi, NULL, false },
+    { "Weather", NULL, "weather", offsetof(FFconfig, weather), ffPrintWeather, ffPrepareWeather, true },
+    { "Player", NULL, "player", offsetof(FFconfig, player), ffPrintPlayer, NULL, false },
+    { "Media", NULL, "media", offsetof(FFconfig, media), ffPrintMedia, NULL, false },
+    { "DateTime", NULL, "datetime", offsetof(FFconfig, dateTime), ffPrintDateTime, NULL, false },
+    { "Date", NULL, "date", offsetof(FFconfig, date), ffPrintDate, NULL, false },
+    { "Time", NULL, "time", offsetof(FFconfig, time), ffPrintTime, NULL, false },
+    { "Colors", NULL, NULL, FF_MODULE_ARGS_NONE, ffPrintColors, NULL, false },
+    { "Vulkan", NULL, "vulkan", offsetof(FFconfig, vulkan), ffPrintVulkan, NULL, false },
+    { "OpenGL", NULL, "opengl", offsetof(FFconfig, openGL), ffPrintOpenGL, NULL, false },
+    { "OpenCL", NULL, "opencl", offsetof(FFconfig, openCL), ffPrintOpenCL, NULL, false },
+    { "Users", NULL, "users", offsetof(FFconfig, users), ffPrintUsers, NULL, false },
+    { "Command", NULL, NULL, FF_MODULE_ARGS_NONE, ffPrintCommand, NULL, false },
+    { "Bluetooth", NULL, "bluetooth", offsetof(FFconfig, bluetooth), ffPrintBluetooth, NULL, false },
+    { "Sound", NULL, "sound", offsetof(FFconfig, sound), ffPrintSound, NULL, false },
+    { "Gamepad", NULL, "gamepad", offsetof(FFconfig, gamepad), ffPrintGamepad, NULL, false },
+};
+
+const uint32_t ffModulesCount = sizeof(ffModules) / sizeof(ffModules[0]);
+
+// Index + 1 into ffModules, 0 if the slot is empty.
+// Generated from ffModuleHash of every name and alias. If a module is added, `fastfetch-test-modules` prints the new table
+static const uint8_t moduleSlots[FF_MODULE_HASH_SIZE] = {
+     0, 26,  0,  0,  0, 28,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0, 43,  0,  0, 11,  0,  0,  0, 49, 40, 31, 41,  0,  0,  0,
+     0,  0,  0,  0, 16, 35, 48,  0, 52,  0,  0, 21,  0,  0,  1, 30,
+     0, 34,  3,  0,  0,  0,  0, 45, 51,  0,  0, 22,  0,  0,  6, 46,
+    38, 42, 39,  0,  9,  0, 19,  0, 37, 25,  0,  0,  0,  0,  0,  2,
+    13,  8, 27,  0, 50,  0,  0,  0,  0,  4,  0, 29, 33,  7, 47, 18,
+    14,  0, 17,  0, 15, 16,  0,  0,  5,  0, 44,  0,  0,  0, 20, 24,
+    10, 36, 12, 32,  0,  0,  0,  0,  0, 17,  0,  0,  0,  0,  0, 23,
+};
+
+uint32_t ffModuleHash(const char* name)
+{
+    // FNV-1a of the lower case name, spread over the table with a multiplicative hash
+    uint32_t hash = 0x811C9DC5u;
+    for(; *name != '\0'; ++name)
+    {
+        hash ^= (uint8_t) tolower((unsigned char) *name);
+        hash *= 0x01000193u;
+    }
+    return (hash * FF_MODULE_HASH_SEED) >> (32 - FF_MODULE_HASH_BITS);
+}
+
+const FFModuleInfo* ffModuleFind(const char* name)
+{
+    uint8_t slot = moduleSlots[ffModuleHash(name)];
+    if(slot == 0)
+        return NULL;
+
+    // A different name can hash into the same slot, so verify it
+    const FFModuleInfo* module = &ffModules[slot - 1];
+    if(strcasecmp(module->name, name) == 0 || (module->alias != NULL && strcasecmp(module->alias, name) == 0))
+        return module;
+
+    return NULL;
+}
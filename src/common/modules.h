@@ -0,0 +1,44 @@
+#pragma once
+
+#ifndef FF_INCLUDED_common_modules
+#define FF_INCLUDED_common_modules
+
+#include "fastfetch.h"
+
+#include <stddef.h>
+
+#define FF_MODULE_ARGS_NONE SIZE_MAX
+
+typedef struct FFModuleInfo
+{
+    const char* name; // Used in the structure, case insensitive
+    const char* alias; // Alternative structure name, NULL if none
+    const char* optionName; // --<optionName>-key / -format / -error, NULL if the module has no FFModuleArgs
+    size_t argsOffset; // offsetof(FFconfig, <args>), FF_MODULE_ARGS_NONE if the module has no FFModuleArgs
+    void (*print)(FFinstance* instance);
+    void (*prepare)(FFinstance* instance); // Called before ffStart if the module is in the structure, NULL if not needed
+    bool prepareNeedsMultithreading; // prepare starts a background thread and is useless without multithreading
+} FFModuleInfo;
+
+// All modules. Use ffModuleFind to look them up by name
+extern const FFModuleInfo ffModules[];
+extern const uint32_t ffModulesCount;
+
+// Size of the perfect hash table of all names and aliases. Must be a power of two
+#define FF_MODULE_HASH_BITS 7
+#define FF_MODULE_HASH_SIZE (1u << FF_MODULE_HASH_BITS)
+
+// Slot of a name in the perfect hash table, case insensitive
+uint32_t ffModuleHash(const char* name);
+
+// Finds a module by name or alias, case insensitive. NULL if there is no such module
+const FFModuleInfo* ffModuleFind(const char* name);
+
+static inline FFModuleArgs* ffModuleGetArgs(FFconfig* config, const FFModuleInfo* module)
+{
+    if(module->argsOffset == FF_MODULE_ARGS_NONE)
+        return NULL;
+    return (FFModuleArgs*) ((char*) config + module->argsOffset);
+}
+
+#endif
@@ -51,32 +51,61 @@ int8_t ffVersionCompare(const FFVersion* version1, const FFVersion* version2)
 void ffVersionToPretty(const FFVersion* version, FFstrbuf* pretty)
 {
     if(version->major > 0 || version->minor > 0 || version->patch > 0)
-        ffStrbufAppendF(pretty, "%u", version->major);
+        ffStrbufAppendUInt(pretty, version->major);
 
     if(version->minor > 0 || version->patch > 0)
-        ffStrbufAppendF(pretty, ".%u", version->minor);
+    {
+        ffStrbufAppendC(pretty, '.');
+        ffStrbufAppendUInt(pretty, version->minor);
+    }
 
     if(version->patch > 0)
-        ffStrbufAppendF(pretty, ".%u", version->patch);
+    {
+        ffStrbufAppendC(pretty, '.');
+        ffStrbufAppendUInt(pretty, version->patch);
+    }
+}
+
+// bytes / divisor with the given number of decimals (0 - 2), rounded half to even like printf
+static void appendQuotient(FFstrbuf* result, uint64_t bytes, uint64_t divisor, uint32_t decimals)
+{
+    uint64_t scale = decimals == 2 ? 100 : decimals == 1 ? 10 : 1;
+    uint64_t remainder = bytes % divisor * scale; // < divisor * 100, which is far below UINT64_MAX
+    uint64_t scaled = bytes / divisor * scale + remainder / divisor;
+    remainder %= divisor;
+
+    if(remainder * 2 > divisor || (remainder * 2 == divisor && scaled % 2 == 1))
+        ++scaled;
+
+    ffStrbufAppendUInt(result, scaled / scale);
+    if(decimals == 0)
+        return;
+
+    ffStrbufAppendC(result, '.');
+    if(decimals == 2)
+        ffStrbufAppendC(result, (char) ('0' + scaled / 10 % 10));
+    ffStrbufAppendC(result, (char) ('0' + scaled % 10));
 }
 
 static void parseSize(FFstrbuf* result, uint64_t bytes, uint32_t base, uint8_t prefixesLength, const char** prefixes)
 {
-    long double size = (long double) bytes;
+    //Integer arithmetic, so that the output is exact and printf is not needed. divisor is base ^ counter
+    uint64_t divisor = 1;
     uint8_t counter = 0;
 
-    while(size > base && counter < prefixesLength - 1)
+    while(bytes > divisor * base && counter < prefixesLength - 1)
     {
-        size /= base;
+        divisor *= base;
         counter++;
     }
 
-    if(counter == 0)
-        ffStrbufAppendF(result, "%"PRIu64" %s", bytes, prefixes[0]);
-    else if(counter < 3 || (counter == 3 && size < 100.0))
-        ffStrbufAppendF(result, "%.2Lf %s", size, prefixes[counter]);
+    if(counter < 3 || (counter == 3 && bytes < divisor * 100))
+        appendQuotient(result, bytes, divisor, counter == 0 ? 0 : 2);
     else
-        ffStrbufAppendF(result, "%.0Lf %s", size, prefixes[counter]);
+        appendQuotient(result, bytes, divisor, 0);
+
+    ffStrbufAppendC(result, ' ');
+    ffStrbufAppendS(result, prefixes[counter]);
 }
 
 void ffParseSize(uint64_t bytes, FFBinaryPrefixType binaryPrefix, FFstrbuf* result)
@@ -0,0 +1,292 @@
+#include "fastfetch.h"
+#include "common/caching.h"
+#include "common/io/io.h"
+#include "common/thread.h"
+#include "common/pciids.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// The index is invalidated by any change of the source file
+typedef struct PciIdsKey
+{
+    uint64_t mtime;
+    uint64_t size;
+    uint64_t inode;
+} PciIdsKey;
+
+typedef struct PciIdsHeader
+{
+    uint32_t vendorCount;
+    uint32_t deviceCount;
+} PciIdsHeader;
+
+typedef struct PciIdsVendor
+{
+    uint16_t id;
+    uint16_t reserved;
+    uint32_t name; // Offset into the string table
+    uint32_t firstDevice;
+    uint32_t deviceCount;
+} PciIdsVendor;
+
+typedef struct PciIdsDevice
+{
+    uint16_t id;
+    uint16_t reserved;
+    uint32_t name;
+} PciIdsDevice;
+
+// Layout of the index: PciIdsHeader, PciIdsVendor[vendorCount] sorted by id,
+// PciIdsDevice[deviceCount] sorted by id per vendor, zero terminated names
+typedef struct PciIdsIndex
+{
+    const PciIdsHeader* header;
+    const PciIdsVendor* vendors;
+    const PciIdsDevice* devices;
+    const char* strings;
+    uint32_t stringsLength;
+} PciIdsIndex;
+
+static bool findPciIds(const FFinstance* instance, FFstrbuf* path, struct stat* fileInfo)
+{
+    const char* relativePaths[] = {"hwdata/pci.ids", "misc/pci.ids", "pciids/pci.ids", "pci.ids"};
+
+    FF_LIST_FOR_EACH(FFstrbuf, dataDir, instance->state.platform.dataDirs)
+    {
+        for(uint32_t i = 0; i < sizeof(relativePaths) / sizeof(relativePaths[0]); i++)
+        {
+            ffStrbufSet(path, dataDir);
+            ffStrbufAppendS(path, relativePaths[i]);
+            if(stat(path->chars, fileInfo) == 0 && S_ISREG(fileInfo->st_mode))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+static uint16_t parseHexId(const char* line, bool* ok)
+{
+    uint16_t id = 0;
+    for(uint32_t i = 0; i < 4; i++)
+    {
+        char c = line[i];
+        uint16_t digit;
+        if(c >= '0' && c <= '9')
+            digit = (uint16_t) (c - '0');
+        else if(c >= 'a' && c <= 'f')
+            digit = (uint16_t) (c - 'a' + 10);
+        else if(c >= 'A' && c <= 'F')
+            digit = (uint16_t) (c - 'A' + 10);
+        else
+        {
+            *ok = false;
+            return 0;
+        }
+        id = (uint16_t) (id << 4 | digit);
+    }
+    //The id is followed by two spaces and the name
+    *ok = line[4] == ' ';
+    return id;
+}
+
+static uint32_t appendName(FFstrbuf* strings, const char* name, const char* lineEnd)
+{
+    while(*name == ' ')
+        ++name;
+
+    uint32_t offset = strings->length;
+    ffStrbufAppendNS(strings, (uint32_t) (lineEnd - name), name);
+    ffStrbufAppendC(strings, '\0');
+    return offset;
+}
+
+static int compareVendors(const void* a, const void* b)
+{
+    return (int) ((const PciIdsVendor*) a)->id - (int) ((const PciIdsVendor*) b)->id;
+}
+
+static int compareDevices(const void* a, const void* b)
+{
+    return (int) ((const PciIdsDevice*) a)->id - (int) ((const PciIdsDevice*) b)->id;
+}
+
+static bool buildIndex(const char* path, FFstrbuf* index)
+{
+    FF_STRBUF_AUTO_DESTROY content;
+    ffStrbufInit(&content);
+    if(!ffAppendFileBuffer(path, &content))
+        return false;
+
+    FF_LIST_AUTO_DESTROY vendors;
+    ffListInitA(&vendors, sizeof(PciIdsVendor), 2048);
+    FF_LIST_AUTO_DESTROY devices;
+    ffListInitA(&devices, sizeof(PciIdsDevice), 32768);
+    FF_STRBUF_AUTO_DESTROY strings;
+    ffStrbufInitA(&strings, content.length / 2);
+
+    PciIdsVendor* vendor = NULL;
+
+    for(const char* line = content.chars; *line != '\0';)
+    {
+        const char* lineEnd = strchr(line, '\n');
+        if(lineEnd == NULL)
+            lineEnd = line + strlen(line);
+
+        bool ok;
+        if(line[0] == 'C' && line[1] == ' ')
+            break; // Device classes follow the vendors, we don't need them
+        else if(line[0] == '\t' && line[1] != '\t')
+        {
+            // Device of the current vendor. Lines starting with two tabs are subsystems, which we skip
+            uint16_t id = parseHexId(line + 1, &ok);
+            if(ok && vendor != NULL)
+            {
+                *(PciIdsDevice*) ffListAdd(&devices) = (PciIdsDevice) {
+                    .id = id,
+                    .name = appendName(&strings, line + 5, lineEnd),
+                };
+                ++vendor->deviceCount;
+            }
+        }
+        else if(line[0] != '\t' && line[0] != '#')
+        {
+            uint16_t id = parseHexId(line, &ok);
+            vendor = ok ? ffListAdd(&vendors) : NULL;
+            if(vendor != NULL)
+            {
+                *vendor = (PciIdsVendor) {
+                    .id = id,
+                    .name = appendName(&strings, line + 4, lineEnd),
+                    .firstDevice = devices.length,
+                };
+            }
+        }
+
+        line = *lineEnd == '\n' ? lineEnd + 1 : lineEnd;
+    }
+
+    if(vendors.length == 0)
+        return false;
+
+    // pci.ids is sorted, but we don't rely on it
+    FF_LIST_FOR_EACH(PciIdsVendor, v, vendors)
+        qsort(ffListGet(&devices, v->firstDevice), v->deviceCount, sizeof(PciIdsDevice), compareDevices);
+    qsort(vendors.data, vendors.length, sizeof(PciIdsVendor), compareVendors);
+
+    ffStrbufAppendNS(index, sizeof(PciIdsHeader), (const char*) &(PciIdsHeader) {
+        .vendorCount = vendors.length,
+        .deviceCount = devices.length,
+    });
+    ffStrbufAppendNS(index, vendors.length * (uint32_t) sizeof(PciIdsVendor), (const char*) vendors.data);
+    ffStrbufAppendNS(index, devices.length * (uint32_t) sizeof(PciIdsDevice), (const char*) devices.data);
+    ffStrbufAppendNS(index, strings.length, strings.chars);
+    return true;
+}
+
+static bool setIndex(PciIdsIndex* index, const char* data, uint32_t dataSize)
+{
+    if(dataSize < sizeof(PciIdsHeader))
+        return false;
+
+    const PciIdsHeader* header = (const PciIdsHeader*) data;
+    size_t tablesSize = sizeof(PciIdsHeader) + header->vendorCount * sizeof(PciIdsVendor) + header->deviceCount * sizeof(PciIdsDevice);
+    if(tablesSize > dataSize)
+        return false;
+
+    index->header = header;
+    index->vendors = (const PciIdsVendor*) (header + 1);
+    index->devices = (const PciIdsDevice*) (index->vendors + header->vendorCount);
+    index->strings = data + tablesSize;
+    index->stringsLength = dataSize - (uint32_t) tablesSize;
+    return true;
+}
+
+static void loadIndex(const FFinstance* instance, PciIdsIndex* index)
+{
+    FF_STRBUF_AUTO_DESTROY path;
+    ffStrbufInit(&path);
+    struct stat fileInfo;
+    if(!findPciIds(instance, &path, &fileInfo))
+        return;
+
+    PciIdsKey key = {
+        .mtime = (uint64_t) fileInfo.st_mtime,
+        .size = (uint64_t) fileInfo.st_size,
+        .inode = (uint64_t) fileInfo.st_ino,
+    };
+
+    uint32_t dataSize;
+    const char* data = ffCacheMap(instance, "pciids", sizeof(key), &key, &dataSize);
+    if(data != NULL && setIndex(index, data, dataSize))
+        return;
+
+    // The built index stays in memory if it can't be written. It is only used by this process then
+    FFstrbuf built;
+    ffStrbufInit(&built);
+    if(!buildIndex(path.chars, &built))
+    {
+        ffStrbufDestroy(&built);
+        return;
+    }
+
+    ffCacheWriteStrbuf(instance, "pciids", sizeof(key), &key, &built);
+    setIndex(index, built.chars, built.length);
+}
+
+static const PciIdsIndex* getIndex(const FFinstance* instance)
+{
+    static PciIdsIndex index;
+    static FFThreadMutex mutex = FF_THREAD_MUTEX_INITIALIZER;
+    static bool init = false;
+
+    ffThreadMutexLock(&mutex);
+    if(!init)
+    {
+        init = true;
+        loadIndex(instance, &index);
+    }
+    ffThreadMutexUnlock(&mutex);
+
+    return index.header != NULL ? &index : NULL;
+}
+
+static bool appendString(const PciIdsIndex* index, uint32_t offset, FFstrbuf* result)
+{
+    if(offset >= index->stringsLength)
+        return false;
+
+    ffStrbufAppendNS(result, (uint32_t) strnlen(index->strings + offset, index->stringsLength - offset), index->strings + offset);
+    return true;
+}
+
+static const PciIdsVendor* findVendor(const PciIdsIndex* index, uint16_t vendorId)
+{
+    return bsearch(&(PciIdsVendor) { .id = vendorId }, index->vendors, index->header->vendorCount, sizeof(PciIdsVendor), compareVendors);
+}
+
+bool ffPciIdsLookupVendor(const FFinstance* instance, uint16_t vendorId, FFstrbuf* result)
+{
+    const PciIdsIndex* index = getIndex(instance);
+    if(index == NULL)
+        return false;
+
+    const PciIdsVendor* vendor = findVendor(index, vendorId);
+    return vendor != NULL && appendString(index, vendor->name, result);
+}
+
+bool ffPciIdsLookupDevice(const FFinstance* instance, uint16_t vendorId, uint16_t deviceId, FFstrbuf* result)
+{
+    const PciIdsIndex* index = getIndex(instance);
+    if(index == NULL)
+        return false;
+
+    const PciIdsVendor* vendor = findVendor(index, vendorId);
+    if(vendor == NULL || (uint64_t) vendor->firstDevice + vendor->deviceCount > index->header->deviceCount)
+        return false;
+
+    const PciIdsDevice* device = bsearch(&(PciIdsDevice) { .id = deviceId }, index->devices + vendor->firstDevice, vendor->deviceCount, sizeof(PciIdsDevice), compareDevices);
+    return device != NULL && appendString(index, device->name, result);
+}
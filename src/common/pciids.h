@@ -0,0 +1,13 @@
+#pragma once
+
+#ifndef FF_INCLUDED_common_pciids
+#define FF_INCLUDED_common_pciids
+
+#include "fastfetch.h"
+
+// Name lookups in pci.ids. The text file is converted once into a sorted binary index in the cache dir,
+// which is mmap'ed and binary searched. The index is rebuilt when pci.ids changes.
+bool ffPciIdsLookupVendor(const FFinstance* instance, uint16_t vendorId, FFstrbuf* result);
+bool ffPciIdsLookupDevice(const FFinstance* instance, uint16_t vendorId, uint16_t deviceId, FFstrbuf* result);
+
+#endif
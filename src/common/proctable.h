@@ -0,0 +1,30 @@
+#pragma once
+
+#ifndef FF_INCLUDED_common_proctable
+#define FF_INCLUDED_common_proctable
+
+#include "fastfetch.h"
+
+typedef struct FFProcessEntry
+{
+    uint32_t pid;
+    uint32_t ppid;
+    uint32_t uid; // Real uid, UINT32_MAX if unknown
+    char comm[64]; // From stat, truncated to 15 chars by the kernel
+    bool argv0Read;
+    FFstrbuf argv0; // First argument of cmdline, not truncated. Use ffProcTableGetArgv0
+} FFProcessEntry;
+
+// Snapshot of /proc shared by all detections. Entries are allocated once and stay valid until the process exits.
+
+// Reads a single process on demand. NULL if it doesn't exist
+const FFProcessEntry* ffProcTableGet(uint32_t pid);
+
+// Reads all processes (once) with getdents64, in parallel if threads are enabled.
+// cmdline is read eagerly for processes owned by the current user. Returns a list of const FFProcessEntry*, sorted by pid
+const FFlist* ffProcTableGetAll(void);
+
+// Empty if cmdline can't be read (e.g. kernel threads)
+const FFstrbuf* ffProcTableGetArgv0(const FFProcessEntry* entry);
+
+#endif
@@ -0,0 +1,350 @@
+#include "fastfetch.h"
+#include "common/io/io.h"
+#include "common/proctable.h"
+#include "common/thread.h"
+#include "util/FFarena.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#else
+#include <dirent.h>
+#endif
+
+#define FF_PROC_TABLE_MAX_THREADS 4
+#define FF_PROC_TABLE_MIN_PER_THREAD 256
+
+typedef struct FFProcTable
+{
+    FFThreadMutex mutex;
+    FFlist entries; // FFProcessEntry*, sorted by pid
+    bool complete;
+} FFProcTable;
+
+static FFProcTable table = { .mutex = FF_THREAD_MUTEX_INITIALIZER };
+
+static void readArgv0(int pidfd, FFProcessEntry* entry)
+{
+    entry->argv0Read = true;
+
+    int FF_AUTO_CLOSE_FD fd = openat(pidfd, "cmdline", O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return;
+
+    // The arguments are separated by '\0'. Only the first one is needed, which is rarely longer than PATH_MAX
+    ffStrbufEnsureFree(&entry->argv0, 255);
+    ssize_t length;
+    while((length = read(fd, entry->argv0.chars + entry->argv0.length, ffStrbufGetFree(&entry->argv0))) > 0)
+    {
+        entry->argv0.length += (uint32_t) length;
+        entry->argv0.chars[entry->argv0.length] = '\0';
+        if(memchr(entry->argv0.chars, '\0', entry->argv0.length) != NULL || entry->argv0.length >= PATH_MAX)
+            break;
+        ffStrbufEnsureFree(&entry->argv0, entry->argv0.allocated - 1);
+    }
+
+    ffStrbufSubstrBeforeFirstC(&entry->argv0, '\0');
+}
+
+// The real uid from the Uid line of status. On Linux, the owner of /proc/<pid> can't be used,
+// it is root for non dumpable processes, e.g. compositors with file capabilities like kwin_wayland.
+// The procfs of the BSDs has no Uid line, the owner is used there
+static uint32_t readUid(int pidfd)
+{
+    int FF_AUTO_CLOSE_FD fd = openat(pidfd, "status", O_RDONLY | O_CLOEXEC);
+    if(fd >= 0)
+    {
+        // Uid is the 9th line, after Name (at most 64 escaped chars), Umask, State, Tgid, Ngid, Pid, PPid and TracerPid
+        char buffer[512];
+        ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+        if(length > 0)
+        {
+            buffer[length] = '\0';
+            const char* uid = strstr(buffer, "\nUid:");
+            if(uid != NULL)
+                return (uint32_t) strtoul(uid + strlen("\nUid:"), NULL, 10);
+        }
+    }
+
+    struct stat pidInfo;
+    if(fstat(pidfd, &pidInfo) != 0)
+        return UINT32_MAX;
+    return (uint32_t) pidInfo.st_uid;
+}
+
+static FFProcessEntry* readProcess(int procfd, const char* pidStr, uint32_t ownUid)
+{
+    int FF_AUTO_CLOSE_FD pidfd = openat(procfd, pidStr, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(pidfd < 0)
+        return NULL;
+
+    char buffer[512];
+    ssize_t length;
+    {
+        int FF_AUTO_CLOSE_FD statfd = openat(pidfd, "stat", O_RDONLY | O_CLOEXEC);
+        if(statfd < 0)
+            return NULL;
+        length = read(statfd, buffer, sizeof(buffer) - 1);
+    }
+    if(length <= 0)
+        return NULL;
+    buffer[length] = '\0';
+
+    // pid (comm) state ppid ... comm may contain spaces and parentheses, so search the last ')'
+    char* commStart = strchr(buffer, '(');
+    char* commEnd = strrchr(buffer, ')');
+    if(commStart == NULL || commEnd == NULL || commEnd < commStart || commEnd[1] != ' ' || commEnd[2] == '\0')
+        return NULL;
+
+    // Entries are never freed, and the scan threads allocate from their own arena blocks
+    FFProcessEntry* entry = ffArenaAlloc(sizeof(FFProcessEntry));
+    if(entry == NULL)
+        entry = malloc(sizeof(FFProcessEntry));
+    entry->pid = (uint32_t) strtoul(pidStr, NULL, 10);
+    entry->ppid = (uint32_t) strtoul(commEnd + 4, NULL, 10); // ") S ppid"
+    entry->uid = readUid(pidfd);
+
+    size_t commLength = (size_t) (commEnd - commStart - 1);
+    if(commLength >= sizeof(entry->comm))
+        commLength = sizeof(entry->comm) - 1;
+    memcpy(entry->comm, commStart + 1, commLength);
+    entry->comm[commLength] = '\0';
+
+    entry->argv0Read = false;
+    ffStrbufInitArena(&entry->argv0);
+    if(entry->uid == ownUid)
+        readArgv0(pidfd, entry);
+
+    return entry;
+}
+
+static int compareEntries(const void* a, const void* b)
+{
+    uint32_t x = (*(FFProcessEntry* const*) a)->pid;
+    uint32_t y = (*(FFProcessEntry* const*) b)->pid;
+    return x < y ? -1 : x > y;
+}
+
+static FFProcessEntry** findEntry(uint32_t pid)
+{
+    FFProcessEntry key = { .pid = pid };
+    FFProcessEntry* keyPtr = &key;
+    return bsearch(&keyPtr, table.entries.data, table.entries.length, sizeof(FFProcessEntry*), compareEntries);
+}
+
+static void ensureInit(void)
+{
+    if(table.entries.elementSize == 0)
+        ffListInitArena(&table.entries, sizeof(FFProcessEntry*));
+}
+
+const FFProcessEntry* ffProcTableGet(uint32_t pid)
+{
+    ffThreadMutexLock(&table.mutex);
+    ensureInit();
+
+    FFProcessEntry** found = findEntry(pid);
+    FFProcessEntry* entry = found ? *found : NULL;
+
+    if(entry == NULL && !table.complete)
+    {
+        int FF_AUTO_CLOSE_FD procfd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        char pidStr[16];
+        snprintf(pidStr, sizeof(pidStr), "%u", pid);
+        if(procfd >= 0 && (entry = readProcess(procfd, pidStr, (uint32_t) getuid())) != NULL)
+        {
+            // Keep the list sorted
+            uint32_t index = 0;
+            while(index < table.entries.length && (*(FFProcessEntry**) ffListGet(&table.entries, index))->pid < pid)
+                ++index;
+            ffListAdd(&table.entries);
+            FFProcessEntry** data = (FFProcessEntry**) table.entries.data;
+            memmove(data + index + 1, data + index, (table.entries.length - 1 - index) * sizeof(FFProcessEntry*));
+            data[index] = entry;
+        }
+    }
+
+    ffThreadMutexUnlock(&table.mutex);
+    return entry;
+}
+
+const FFstrbuf* ffProcTableGetArgv0(const FFProcessEntry* entry)
+{
+    ffThreadMutexLock(&table.mutex);
+    if(!entry->argv0Read)
+    {
+        int FF_AUTO_CLOSE_FD procfd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        char pidStr[16];
+        snprintf(pidStr, sizeof(pidStr), "%u", entry->pid);
+        int FF_AUTO_CLOSE_FD pidfd = procfd >= 0 ? openat(procfd, pidStr, O_RDONLY | O_DIRECTORY | O_CLOEXEC) : -1;
+
+        // Entries are owned by the table, which is only modified with the mutex locked
+        FFProcessEntry* mutableEntry = (FFProcessEntry*) entry;
+        if(pidfd >= 0)
+            readArgv0(pidfd, mutableEntry);
+        else
+            mutableEntry->argv0Read = true;
+    }
+    ffThreadMutexUnlock(&table.mutex);
+    return &entry->argv0;
+}
+
+typedef struct FFProcScanJob
+{
+    int procfd;
+    uint32_t ownUid;
+    const char* const* pids;
+    FFProcessEntry** results;
+    uint32_t count;
+} FFProcScanJob;
+
+static void scanPids(FFProcScanJob* job)
+{
+    for(uint32_t i = 0; i < job->count; i++)
+        job->results[i] = readProcess(job->procfd, job->pids[i], job->ownUid);
+}
+
+FF_THREAD_ENTRY_DECL_WRAPPER(scanPids, FFProcScanJob*)
+
+static void addPid(FFstrbuf* names, FFlist* pids, const char* name)
+{
+    if(name[0] < '1' || name[0] > '9')
+        return;
+
+    // Offsets for now, because names may be reallocated
+    *(uint32_t*) ffListAdd(pids) = names->length;
+    ffStrbufAppendS(names, name);
+    ffStrbufAppendC(names, '\0');
+}
+
+#ifdef __linux__
+// Lists the pid directories of /proc with getdents64, which returns many entries per syscall without a DIR* buffer
+static void listPids(int procfd, FFstrbuf* names, FFlist* pids)
+{
+    char buffer[32 * 1024];
+    long length;
+    while((length = syscall(SYS_getdents64, procfd, buffer, sizeof(buffer))) > 0)
+    {
+        for(long offset = 0; offset < length;)
+        {
+            // struct linux_dirent64: ino (8), off (8), reclen (2), type (1), name
+            uint16_t reclen;
+            memcpy(&reclen, buffer + offset + 16, sizeof(reclen));
+            addPid(names, pids, buffer + offset + 19);
+            offset += reclen;
+        }
+    }
+}
+#else
+static void listPids(int procfd, FFstrbuf* names, FFlist* pids)
+{
+    // closedir closes the fd, which is owned by the caller
+    DIR* dir = fdopendir(dup(procfd));
+    if(dir == NULL)
+        return;
+
+    struct dirent* entry;
+    while((entry = readdir(dir)) != NULL)
+        addPid(names, pids, entry->d_name);
+
+    closedir(dir);
+}
+#endif
+
+static void scanAll(void)
+{
+    int FF_AUTO_CLOSE_FD procfd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(procfd < 0)
+        return;
+
+    FF_STRBUF_AUTO_DESTROY names;
+    ffStrbufInitA(&names, 8 * 1024);
+    FF_LIST_AUTO_DESTROY offsets;
+    ffListInitA(&offsets, sizeof(uint32_t), 1024);
+    listPids(procfd, &names, &offsets);
+
+    // Skip processes which were already read by ffProcTableGet
+    FF_LIST_AUTO_DESTROY pids;
+    ffListInitA(&pids, sizeof(const char*), offsets.length);
+    FF_LIST_FOR_EACH(uint32_t, offset, offsets)
+    {
+        const char* pid = names.chars + *offset;
+        if(findEntry((uint32_t) strtoul(pid, NULL, 10)) == NULL)
+            *(const char**) ffListAdd(&pids) = pid;
+    }
+
+    FFProcessEntry** results = calloc(pids.length + 1, sizeof(FFProcessEntry*));
+    uint32_t ownUid = (uint32_t) getuid();
+
+    #ifdef FF_HAVE_THREADS
+        uint32_t threadCount = pids.length / FF_PROC_TABLE_MIN_PER_THREAD;
+        if(threadCount > FF_PROC_TABLE_MAX_THREADS)
+            threadCount = FF_PROC_TABLE_MAX_THREADS;
+    #else
+        uint32_t threadCount = 0;
+    #endif
+
+    if(threadCount > 1)
+    {
+        #ifdef FF_HAVE_THREADS
+            FFProcScanJob jobs[FF_PROC_TABLE_MAX_THREADS];
+            FFThreadType threads[FF_PROC_TABLE_MAX_THREADS];
+            uint32_t perThread = (pids.length + threadCount - 1) / threadCount;
+            for(uint32_t i = 0; i < threadCount; i++)
+            {
+                uint32_t start = i * perThread;
+                jobs[i] = (FFProcScanJob) {
+                    .procfd = procfd,
+                    .ownUid = ownUid,
+                    .pids = (const char* const*) pids.data + start,
+                    .results = results + start,
+                    .count = start >= pids.length ? 0 : (pids.length - start < perThread ? pids.length - start : perThread),
+                };
+                // The last slice is scanned by this thread
+                if(i < threadCount - 1)
+                    threads[i] = ffThreadCreate(scanPidsThreadMain, &jobs[i]);
+            }
+            scanPids(&jobs[threadCount - 1]);
+            for(uint32_t i = 0; i < threadCount - 1; i++)
+                ffThreadJoin(threads[i]);
+        #endif
+    }
+    else
+    {
+        scanPids(&(FFProcScanJob) {
+            .procfd = procfd,
+            .ownUid = ownUid,
+            .pids = (const char* const*) pids.data,
+            .results = results,
+            .count = pids.length,
+        });
+    }
+
+    for(uint32_t i = 0; i < pids.length; i++)
+    {
+        if(results[i] != NULL)
+            *(FFProcessEntry**) ffListAdd(&table.entries) = results[i];
+    }
+    free(results);
+
+    qsort(table.entries.data, table.entries.length, sizeof(FFProcessEntry*), compareEntries);
+}
+
+const FFlist* ffProcTableGetAll(void)
+{
+    ffThreadMutexLock(&table.mutex);
+    ensureInit();
+    if(!table.complete)
+    {
+        table.complete = true;
+        scanAll();
+    }
+    ffThreadMutexUnlock(&table.mutex);
+    return &table.entries;
+}
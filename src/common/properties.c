@@ -1,7 +1,13 @@
 #include "fastfetch.h"
+#include "common/caching.h"
+#include "common/io/io.h"
 #include "common/properties.h"
+#include "common/thread.h"
+#include "util/mallocHelper.h"
 
 #include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 #ifdef _WIN32
     #include "util/windows/getline.h"
 #endif
@@ -193,3 +199,306 @@ bool ffParsePropFileListValues(const FFlist* list, const char* relativeFile, uin
 
     return foundAFile;
 }
+
+typedef struct FFPropIndexKey
+{
+    uint64_t mtime;
+    uint64_t size;
+    uint64_t inode;
+    uint32_t separator;
+    uint32_t keyFields;
+} FFPropIndexKey;
+
+// Layout of a persisted index: header, uint32_t buckets[bucketCount] (entry index + 1, 0 if empty),
+// FFPropIndexEntry entries[entryCount], zero terminated keys and values
+typedef struct FFPropIndexHeader
+{
+    uint32_t bucketCount; // Power of 2
+    uint32_t entryCount;
+} FFPropIndexHeader;
+
+typedef struct FFPropIndexEntry
+{
+    uint32_t hash;
+    uint32_t key; // Offset into the string table
+    uint32_t value;
+} FFPropIndexEntry;
+
+typedef struct FFPropIndex
+{
+    FFstrbuf path;
+    const FFPropIndexHeader* header; // NULL if the file couldn't be indexed
+    const uint32_t* buckets;
+    const FFPropIndexEntry* entries;
+    const char* strings;
+    uint32_t stringsLength;
+} FFPropIndex;
+
+static uint32_t hashPropKey(const char* key, uint32_t length)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for(uint32_t i = 0; i < length; i++)
+    {
+        hash ^= (uint8_t) key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Removes all whitespace of the key part. Returns false if the line has less than keyFields separators
+static bool normalizePropKey(const char** line, const char* lineEnd, char separator, uint32_t keyFields, FFstrbuf* key)
+{
+    ffStrbufClear(key);
+    uint32_t fields = 0;
+    for(; *line < lineEnd; ++*line)
+    {
+        char c = **line;
+        if(c == ' ' || c == '\t')
+            continue;
+        ffStrbufAppendC(key, c);
+        if(c == separator && ++fields == keyFields)
+        {
+            ++*line;
+            return true;
+        }
+    }
+    return false;
+}
+
+static const FFPropIndexEntry* findPropIndexEntry(const FFPropIndex* index, const char* key, uint32_t keyLength, uint32_t hash)
+{
+    uint32_t mask = index->header->bucketCount - 1;
+    for(uint32_t i = hash & mask, probes = 0; probes < index->header->bucketCount; i = (i + 1) & mask, probes++)
+    {
+        uint32_t bucket = index->buckets[i];
+        if(bucket == 0 || bucket > index->header->entryCount)
+            return NULL;
+
+        const FFPropIndexEntry* entry = &index->entries[bucket - 1];
+        if(
+            entry->hash == hash &&
+            entry->key + keyLength < index->stringsLength &&
+            memcmp(index->strings + entry->key, key, keyLength) == 0 &&
+            index->strings[entry->key + keyLength] == '\0'
+        ) return entry;
+    }
+    return NULL;
+}
+
+static bool setPropIndex(FFPropIndex* index, const char* data, uint32_t dataSize)
+{
+    if(dataSize < sizeof(FFPropIndexHeader))
+        return false;
+
+    const FFPropIndexHeader* header = (const FFPropIndexHeader*) data;
+    if(header->bucketCount == 0 || (header->bucketCount & (header->bucketCount - 1)) != 0)
+        return false;
+
+    size_t tablesSize = sizeof(*header) + header->bucketCount * sizeof(uint32_t) + header->entryCount * sizeof(FFPropIndexEntry);
+    if(tablesSize > dataSize)
+        return false;
+
+    index->header = header;
+    index->buckets = (const uint32_t*) (header + 1);
+    index->entries = (const FFPropIndexEntry*) (index->buckets + header->bucketCount);
+    index->strings = data + tablesSize;
+    index->stringsLength = dataSize - (uint32_t) tablesSize;
+    return true;
+}
+
+static bool buildPropIndex(const char* filename, char separator, uint32_t keyFields, FFstrbuf* result)
+{
+    FF_STRBUF_AUTO_DESTROY content;
+    ffStrbufInit(&content);
+    if(!ffAppendFileBuffer(filename, &content))
+        return false;
+
+    FF_LIST_AUTO_DESTROY entries;
+    ffListInitA(&entries, sizeof(FFPropIndexEntry), 1024);
+    FF_STRBUF_AUTO_DESTROY strings;
+    ffStrbufInitA(&strings, content.length);
+    FF_STRBUF_AUTO_DESTROY key;
+    ffStrbufInit(&key);
+
+    for(const char* line = content.chars; *line != '\0';)
+    {
+        const char* lineEnd = strchr(line, '\n');
+        if(lineEnd == NULL)
+            lineEnd = line + strlen(line);
+
+        const char* value = line;
+        if(*line != '#' && normalizePropKey(&value, lineEnd, separator, keyFields, &key))
+        {
+            while(value < lineEnd && (*value == ' ' || *value == '\t'))
+                ++value;
+            const char* valueEnd = lineEnd;
+            while(valueEnd > value && (valueEnd[-1] == ' ' || valueEnd[-1] == '\r'))
+                --valueEnd;
+
+            FFPropIndexEntry* entry = ffListAdd(&entries);
+            entry->hash = hashPropKey(key.chars, key.length);
+            entry->key = strings.length;
+            ffStrbufAppend(&strings, &key);
+            ffStrbufAppendC(&strings, '\0');
+            entry->value = strings.length;
+            ffStrbufAppendNS(&strings, (uint32_t) (valueEnd - value), value);
+            ffStrbufAppendC(&strings, '\0');
+        }
+
+        line = *lineEnd == '\n' ? lineEnd + 1 : lineEnd;
+    }
+
+    // Load factor <= 0.5
+    uint32_t bucketCount = 16;
+    while(bucketCount < entries.length * 2)
+        bucketCount *= 2;
+
+    FF_AUTO_FREE uint32_t* buckets = calloc(bucketCount, sizeof(uint32_t));
+    for(uint32_t i = 0; i < entries.length; i++)
+    {
+        const FFPropIndexEntry* entry = ffListGet(&entries, i);
+        uint32_t bucket = entry->hash & (bucketCount - 1);
+        while(buckets[bucket] != 0)
+        {
+            // Later occurrences replace earlier ones, like in ffParsePropFileValues
+            const FFPropIndexEntry* other = ffListGet(&entries, buckets[bucket] - 1);
+            if(other->hash == entry->hash && strcmp(strings.chars + other->key, strings.chars + entry->key) == 0)
+                break;
+            bucket = (bucket + 1) & (bucketCount - 1);
+        }
+        buckets[bucket] = i + 1;
+    }
+
+    ffStrbufAppendNS(result, sizeof(FFPropIndexHeader), (const char*) &(FFPropIndexHeader) {
+        .bucketCount = bucketCount,
+        .entryCount = entries.length,
+    });
+    ffStrbufAppendNS(result, bucketCount * (uint32_t) sizeof(uint32_t), (const char*) buckets);
+    ffStrbufAppendNS(result, entries.length * (uint32_t) sizeof(FFPropIndexEntry), (const char*) entries.data);
+    ffStrbufAppend(result, &strings);
+    return true;
+}
+
+static void loadPropIndex(const FFinstance* instance, const char* filename, char separator, uint32_t keyFields, FFPropIndex* index)
+{
+    struct stat fileInfo;
+    if(stat(filename, &fileInfo) != 0)
+        return;
+
+    FFPropIndexKey key = {
+        .mtime = (uint64_t) fileInfo.st_mtime,
+        .size = (uint64_t) fileInfo.st_size,
+        .inode = (uint64_t) fileInfo.st_ino,
+        .separator = (uint8_t) separator,
+        .keyFields = keyFields,
+    };
+
+    // "/usr/share/libdrm/amdgpu.ids" => "props_usr_share_libdrm_amdgpu.ids"
+    FF_STRBUF_AUTO_DESTROY cacheName;
+    ffStrbufInitS(&cacheName, "props");
+    for(const char* c = filename; *c != '\0'; c++)
+        ffStrbufAppendC(&cacheName, *c == '/' || *c == '\\' || *c == ':' ? '_' : *c);
+
+    #ifndef _WIN32
+        uint32_t dataSize;
+        const char* data = ffCacheMap(instance, cacheName.chars, sizeof(key), &key, &dataSize);
+        if(data != NULL && setPropIndex(index, data, dataSize))
+            return;
+    #endif
+
+    // Kept for the lifetime of the process, like the mapping
+    FFstrbuf* content = malloc(sizeof(FFstrbuf));
+    ffStrbufInit(content);
+
+    #ifdef _WIN32
+        if(ffCacheReadStrbuf(instance, cacheName.chars, sizeof(key), &key, content) && setPropIndex(index, content->chars, content->length))
+            return;
+        ffStrbufClear(content);
+    #endif
+
+    if(buildPropIndex(filename, separator, keyFields, content) && setPropIndex(index, content->chars, content->length))
+        ffCacheWriteStrbuf(instance, cacheName.chars, sizeof(key), &key, content);
+    else
+    {
+        ffStrbufDestroy(content);
+        free(content);
+    }
+}
+
+static const FFPropIndex* getPropIndex(const FFinstance* instance, const char* filename, char separator, uint32_t keyFields)
+{
+    static FFThreadMutex mutex = FF_THREAD_MUTEX_INITIALIZER;
+    static FFlist indexes; // FFPropIndex*, usually only a few files are looked up
+    static bool init = false;
+
+    ffThreadMutexLock(&mutex);
+    if(!init)
+    {
+        init = true;
+        ffListInit(&indexes, sizeof(FFPropIndex*));
+    }
+
+    FFPropIndex* index = NULL;
+    FF_LIST_FOR_EACH(FFPropIndex*, item, indexes)
+    {
+        if(ffStrbufCompS(&(*item)->path, filename) == 0)
+        {
+            index = *item;
+            break;
+        }
+    }
+
+    if(index == NULL)
+    {
+        // Allocated separately, so returned pointers stay valid when the list grows
+        index = calloc(1, sizeof(FFPropIndex));
+        ffStrbufInitS(&index->path, filename);
+        loadPropIndex(instance, filename, separator, keyFields, index);
+        *(FFPropIndex**) ffListAdd(&indexes) = index;
+    }
+
+    ffThreadMutexUnlock(&mutex);
+    return index->header != NULL ? index : NULL;
+}
+
+bool ffParsePropFileIndexed(const FFinstance* instance, const char* filename, char separator, uint32_t keyFields, const char* key, FFstrbuf* buffer)
+{
+    const FFPropIndex* index = getPropIndex(instance, filename, separator, keyFields);
+    if(index == NULL)
+        return false;
+
+    FF_STRBUF_AUTO_DESTROY normalized;
+    ffStrbufInit(&normalized);
+    const char* keyEnd = key + strlen(key);
+    if(!normalizePropKey(&key, keyEnd, separator, keyFields, &normalized))
+        return true;
+
+    const FFPropIndexEntry* entry = findPropIndexEntry(index, normalized.chars, normalized.length, hashPropKey(normalized.chars, normalized.length));
+    if(entry != NULL && entry->value < index->stringsLength && buffer->length == 0)
+        ffStrbufAppendS(buffer, index->strings + entry->value);
+
+    return true;
+}
+
+bool ffParsePropFileListIndexed(const FFinstance* instance, const FFlist* list, const char* relativeFile, char separator, uint32_t keyFields, const char* key, FFstrbuf* buffer)
+{
+    bool foundAFile = false;
+
+    FF_STRBUF_AUTO_DESTROY baseDir;
+    ffStrbufInitA(&baseDir, 64);
+
+    FF_LIST_FOR_EACH(FFstrbuf, dir, *list)
+    {
+        ffStrbufSet(&baseDir, dir);
+        ffStrbufAppendS(&baseDir, relativeFile);
+
+        if(ffParsePropFileIndexed(instance, baseDir.chars, separator, keyFields, key, buffer))
+            foundAFile = true;
+
+        if(buffer->length > 0)
+            break;
+    }
+
+    return foundAFile;
+}
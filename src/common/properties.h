@@ -52,4 +52,16 @@ static inline bool ffParsePropFileData(const FFinstance* instance, const char* r
     return ffParsePropFileDataValues(instance, relativeFile, 1, (FFpropquery[]){{start, buffer}});
 }
 
+// Lookups in large "key<separator>...<separator>value" files like libdrm/amdgpu.ids.
+// The key is the line up to and including the keyFields-th separator, whitespace ignored. The rest of the line is the value.
+// On first use a hash index of the file is built and persisted in the detection cache, tagged with the mtime of the file.
+// If a key occurs multiple times, the last occurrence is used.
+bool ffParsePropFileIndexed(const FFinstance* instance, const char* filename, char separator, uint32_t keyFields, const char* key, FFstrbuf* buffer);
+bool ffParsePropFileListIndexed(const FFinstance* instance, const FFlist* list, const char* relativeFile, char separator, uint32_t keyFields, const char* key, FFstrbuf* buffer);
+
+static inline bool ffParsePropFileDataIndexed(const FFinstance* instance, const char* relativeFile, char separator, uint32_t keyFields, const char* key, FFstrbuf* buffer)
+{
+    return ffParsePropFileListIndexed(instance, &instance->state.platform.dataDirs, relativeFile, separator, keyFields, key, buffer);
+}
+
 #endif
@@ -1,9 +1,24 @@
 #include "fastfetch.h"
 #include "common/io/io.h"
 #include "battery.h"
+#include "detection/temps/temps_linux.h"
 
 #include <dirent.h>
 
+static void detectTemperature(const FFinstance* instance, const char* name, BatteryResult* result)
+{
+    //The hwmon device of a power supply has the same name as the power supply
+    FFTempsResult* temps = ffDetectTemps(instance);
+    FF_LIST_FOR_EACH(FFTempValue, value, temps->values)
+    {
+        if(value->role == FF_SENSOR_ROLE_BATTERY && value->type == FF_SENSOR_TYPE_TEMP && ffStrbufCompS(&value->name, name) == 0 && ffTempsUpdateValue(value))
+        {
+            result->temperature = value->value;
+            return;
+        }
+    }
+}
+
 static void parseBattery(FFstrbuf* dir, FFlist* results)
 {
     uint32_t dirLength = dir->length;
@@ -103,7 +118,10 @@ const char* ffDetectBatteryImpl(FFinstance* instance, FFlist* results) {
             continue;
 
         ffStrbufAppendS(&baseDir, entry->d_name);
+        uint32_t length = results->length;
         parseBattery(&baseDir, results);
+        if(instance->config.batteryTemp && results->length > length)
+            detectTemperature(instance, entry->d_name, ffListGet(results, length));
         ffStrbufSubstrBefore(&baseDir, baseDirLength);
     }
 
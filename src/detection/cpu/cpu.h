@@ -6,6 +6,14 @@
 #include "fastfetch.h"
 
 #define FF_CPU_TEMP_UNSET (0/0.0)
+#define FF_CPU_MAX_CLUSTERS 8
+
+typedef struct FFCPUCluster
+{
+    uint16_t cores; // physical cores
+    uint16_t threads;
+    double frequencyMax;
+} FFCPUCluster;
 
 typedef struct FFCPUResult
 {
@@ -15,6 +23,11 @@ typedef struct FFCPUResult
     uint16_t coresPhysical;
     uint16_t coresLogical;
     uint16_t coresOnline;
+    uint16_t packages;
+
+    // Groups of cores with the same max frequency (big.LITTLE, hybrid P / E cores), fastest first
+    uint8_t clusterCount;
+    FFCPUCluster clusters[FF_CPU_MAX_CLUSTERS];
 
     double frequencyMin;
     double frequencyMax;
@@ -1,12 +1,33 @@
 #include "cpu.h"
+#include "common/caching.h"
 #include "common/io/io.h"
 #include "common/properties.h"
 #include "detection/temps/temps_linux.h"
 
 #include <sys/sysinfo.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <dirent.h>
 #include <unistd.h>
 
+// Everything that doesn't change until the next boot. Cached, so /proc/cpuinfo and sysfs are only read once per boot
+typedef struct CPUStaticInfo
+{
+    char name[256];
+    char vendor[64];
+
+    uint16_t coresPhysical;
+    uint16_t packages;
+
+    uint8_t clusterCount;
+    FFCPUCluster clusters[FF_CPU_MAX_CLUSTERS];
+
+    double frequencyMin;
+    double frequencyMax;
+} CPUStaticInfo;
+
 static void parseCpuInfo(FFCPUResult* cpu, FFstrbuf* physicalCoresBuffer, FFstrbuf* cpuMHz, FFstrbuf* cpuIsa, FFstrbuf* cpuUarch)
 {
     FILE* cpuinfo = fopen("/proc/cpuinfo", "r");
@@ -39,50 +60,139 @@ static void parseCpuInfo(FFCPUResult* cpu, FFstrbuf* physicalCoresBuffer, FFstrb
     fclose(cpuinfo);
 }
 
-static double getGHz(const char* file)
+typedef struct CPUTopologyEntry
 {
-    FFstrbuf content;
-    ffStrbufInit(&content);
-    if(ffAppendFileBuffer(file, &content))
-    {
-        double herz = ffStrbufToDouble(&content);
-        ffStrbufDestroy(&content);
+    uint32_t package;
+    uint32_t core; // First CPU of the core's thread siblings, unique across packages and clusters, unlike core_id
+    uint32_t frequencyMin; // kHz
+    uint32_t frequencyMax; // kHz
+} CPUTopologyEntry;
 
-        //ffStrbufToDouble failed
-        if(herz != herz)
-            return 0;
+static bool readSysfsUInt32(int dfd, const char* path, uint32_t* result)
+{
+    int FF_AUTO_CLOSE_FD fd = openat(dfd, path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return false;
 
-        herz /= 1000.0; //to MHz
-        return herz / 1000.0; //to GHz
-    }
-    return 0;
+    char buffer[32];
+    ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+    if(length <= 0)
+        return false;
+    buffer[length] = '\0';
+
+    char* end;
+    unsigned long value = strtoul(buffer, &end, 10);
+    if(end == buffer)
+        return false;
+
+    *result = (uint32_t) value;
+    return true;
 }
 
-static double getFrequency(const char* info, const char* scaling)
+static int compareTopologyEntries(const void* a, const void* b)
 {
-    double frequency = getGHz(info);
-    if(frequency > 0.0)
-        return frequency;
-
-    return getGHz(scaling);
+    const CPUTopologyEntry* x = a;
+    const CPUTopologyEntry* y = b;
+    if(x->frequencyMax != y->frequencyMax)
+        return x->frequencyMax > y->frequencyMax ? -1 : 1;
+    if(x->package != y->package)
+        return x->package < y->package ? -1 : 1;
+    if(x->core != y->core)
+        return x->core < y->core ? -1 : 1;
+    return 0;
 }
 
-static double detectCPUTemp(void)
+static void detectTopology(CPUStaticInfo* info)
 {
-    const FFTempsResult* temps = ffDetectTemps();
+    DIR* dir = opendir("/sys/devices/system/cpu/");
+    if(dir == NULL)
+        return;
 
-    for(uint32_t i = 0; i < temps->values.length; i++)
+    FF_LIST_AUTO_DESTROY entries;
+    ffListInit(&entries, sizeof(CPUTopologyEntry));
+
+    struct dirent* dirEntry;
+    while((dirEntry = readdir(dir)) != NULL)
     {
-        FFTempValue* value = ffListGet(&temps->values, i);
+        if(strncmp(dirEntry->d_name, "cpu", 3) != 0 || !isdigit((unsigned char) dirEntry->d_name[3]))
+            continue;
+
+        // All files of one CPU are read relative to its directory, so the path is resolved only once
+        int FF_AUTO_CLOSE_FD cpufd = openat(dirfd(dir), dirEntry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(cpufd < 0)
+            continue;
 
-        if(
-            ffStrbufFirstIndexS(&value->name, "cpu") < value->name.length ||
-            ffStrbufCompS(&value->name, "k10temp") == 0 ||
-            ffStrbufCompS(&value->name, "coretemp") == 0
-        ) return value->value;
+        CPUTopologyEntry entry = {0};
+        if(!readSysfsUInt32(cpufd, "topology/core_id", &entry.core))
+            continue; // offline
+
+        // core_id restarts in every cluster on some ARM kernels, and may be shared by equal clusters.
+        // The sibling list ("0,4" or "0-1") starts with the same CPU for every thread of a core
+        if(!readSysfsUInt32(cpufd, "topology/thread_siblings_list", &entry.core))
+            entry.core = (uint32_t) strtoul(dirEntry->d_name + 3, NULL, 10);
+
+        readSysfsUInt32(cpufd, "topology/physical_package_id", &entry.package);
+
+        if(!readSysfsUInt32(cpufd, "cpufreq/cpuinfo_max_freq", &entry.frequencyMax))
+            readSysfsUInt32(cpufd, "cpufreq/scaling_max_freq", &entry.frequencyMax);
+        if(!readSysfsUInt32(cpufd, "cpufreq/cpuinfo_min_freq", &entry.frequencyMin))
+            readSysfsUInt32(cpufd, "cpufreq/scaling_min_freq", &entry.frequencyMin);
+
+        *(CPUTopologyEntry*) ffListAdd(&entries) = entry;
     }
 
-    return FF_CPU_TEMP_UNSET;
+    closedir(dir);
+
+    if(entries.length == 0)
+        return;
+
+    // Sorted by max frequency first, so clusters and SMT siblings are adjacent
+    qsort(entries.data, entries.length, entries.elementSize, compareTopologyEntries);
+
+    uint64_t packageMask = 0;
+    uint32_t frequencyMin = UINT32_MAX;
+    uint32_t clusterFrequency = 0;
+    const CPUTopologyEntry* previous = NULL;
+    info->coresPhysical = 0;
+
+    FF_LIST_FOR_EACH(CPUTopologyEntry, entry, entries)
+    {
+        packageMask |= 1ULL << (entry->package & 63);
+        if(entry->frequencyMin > 0 && entry->frequencyMin < frequencyMin)
+            frequencyMin = entry->frequencyMin;
+
+        // Favored cores (Intel Turbo Boost Max 3.0) may boost a few percent higher than their siblings.
+        // Only start a new cluster if the max frequency drops by more than 5%
+        if(info->clusterCount == 0 || (
+            info->clusterCount < FF_CPU_MAX_CLUSTERS &&
+            (uint64_t) entry->frequencyMax * 100 < (uint64_t) clusterFrequency * 95
+        )) {
+            clusterFrequency = entry->frequencyMax;
+            info->clusters[info->clusterCount++] = (FFCPUCluster) {
+                .frequencyMax = entry->frequencyMax / 1000.0 / 1000.0 // kHz to GHz
+            };
+        }
+
+        FFCPUCluster* cluster = &info->clusters[info->clusterCount - 1];
+        ++cluster->threads;
+        if(previous == NULL || previous->package != entry->package || previous->core != entry->core)
+        {
+            ++cluster->cores;
+            ++info->coresPhysical;
+        }
+        previous = entry;
+    }
+
+    info->packages = (uint16_t) __builtin_popcountll(packageMask);
+    info->frequencyMax = info->clusters[0].frequencyMax;
+    if(frequencyMin != UINT32_MAX)
+        info->frequencyMin = frequencyMin / 1000.0 / 1000.0;
+}
+
+static double detectCPUTemp(const FFinstance* instance)
+{
+    const FFTempValue* value = ffTempsFindRole(instance, FF_SENSOR_ROLE_CPU, FF_SENSOR_TYPE_TEMP);
+    return value ? value->value : FF_CPU_TEMP_UNSET;
 }
 
 static void parseIsa(FFstrbuf* cpuIsa)
@@ -104,12 +214,11 @@ static void parseIsa(FFstrbuf* cpuIsa)
     }
 }
 
-void ffDetectCPUImpl(const FFinstance* instance, FFCPUResult* cpu)
+static void detectStaticInfo(CPUStaticInfo* info)
 {
-    if(instance->config.cpuTemp)
-        cpu->temperature = detectCPUTemp();
-    else
-        cpu->temperature = FF_CPU_TEMP_UNSET;
+    FFCPUResult cpu;
+    ffStrbufInit(&cpu.name);
+    ffStrbufInit(&cpu.vendor);
 
     FFstrbuf physicalCoresBuffer;
     ffStrbufInit(&physicalCoresBuffer);
@@ -123,41 +232,79 @@ void ffDetectCPUImpl(const FFinstance* instance, FFCPUResult* cpu)
     FFstrbuf cpuUarch;
     ffStrbufInit(&cpuUarch);
 
-    parseCpuInfo(cpu, &physicalCoresBuffer, &cpuMHz, &cpuIsa, &cpuUarch);
+    parseCpuInfo(&cpu, &physicalCoresBuffer, &cpuMHz, &cpuIsa, &cpuUarch);
 
-    cpu->coresPhysical = ffStrbufToUInt16(&physicalCoresBuffer, 1);
+    detectTopology(info);
 
-    cpu->coresLogical = (uint16_t) get_nprocs_conf();
-    cpu->coresOnline = (uint16_t) get_nprocs();
+    if(info->packages == 0)
+        info->packages = 1;
+    // coresPhysical counts the cores of all packages, "cpu cores" only those of one
+    if(info->coresPhysical == 0)
+        info->coresPhysical = (uint16_t) (ffStrbufToUInt16(&physicalCoresBuffer, 1) * info->packages);
 
-    #define BP "/sys/devices/system/cpu/cpufreq/policy0/"
-    if(ffPathExists(BP, FF_PATHTYPE_DIRECTORY))
+    if(info->frequencyMax <= 0.0)
     {
-        cpu->frequencyMin = getFrequency(BP"cpuinfo_min_freq", BP"scaling_min_freq");
-        cpu->frequencyMax = getFrequency(BP"cpuinfo_max_freq", BP"scaling_max_freq");
-    }
-    else
-    {
-        cpu->frequencyMin = cpu->frequencyMax = ffStrbufToDouble(&cpuMHz) / 1000;
+        info->frequencyMin = info->frequencyMax = ffStrbufToDouble(&cpuMHz) / 1000;
+        if(info->frequencyMax != info->frequencyMax) //ffStrbufToDouble failed
+            info->frequencyMin = info->frequencyMax = 0;
+        if(info->clusterCount == 1)
+            info->clusters[0].frequencyMax = info->frequencyMax;
     }
 
     if(cpuUarch.length > 0)
     {
-        if(cpu->name.length > 0)
-            ffStrbufAppendC(&cpu->name, ' ');
-        ffStrbufAppend(&cpu->name, &cpuUarch);
+        if(cpu.name.length > 0)
+            ffStrbufAppendC(&cpu.name, ' ');
+        ffStrbufAppend(&cpu.name, &cpuUarch);
     }
 
     if(cpuIsa.length > 0)
     {
         parseIsa(&cpuIsa);
-        if(cpu->name.length > 0)
-            ffStrbufAppendC(&cpu->name, ' ');
-        ffStrbufAppend(&cpu->name, &cpuIsa);
+        if(cpu.name.length > 0)
+            ffStrbufAppendC(&cpu.name, ' ');
+        ffStrbufAppend(&cpu.name, &cpuIsa);
     }
 
+    strncpy(info->name, cpu.name.chars, sizeof(info->name) - 1);
+    strncpy(info->vendor, cpu.vendor.chars, sizeof(info->vendor) - 1);
+
+    ffStrbufDestroy(&cpu.name);
+    ffStrbufDestroy(&cpu.vendor);
     ffStrbufDestroy(&physicalCoresBuffer);
     ffStrbufDestroy(&cpuMHz);
     ffStrbufDestroy(&cpuIsa);
     ffStrbufDestroy(&cpuUarch);
 }
+
+void ffDetectCPUImpl(const FFinstance* instance, FFCPUResult* cpu)
+{
+    if(instance->config.cpuTemp)
+        cpu->temperature = detectCPUTemp(instance);
+    else
+        cpu->temperature = FF_CPU_TEMP_UNSET;
+
+    cpu->coresLogical = (uint16_t) get_nprocs_conf();
+    cpu->coresOnline = (uint16_t) get_nprocs();
+
+    char bootId[FF_CACHE_BOOT_ID_LENGTH];
+    bool hasBootId = ffCacheGetBootId(bootId);
+
+    CPUStaticInfo info;
+    if(!hasBootId || !ffCacheRead(instance, "cpu-static", sizeof(bootId), bootId, sizeof(info), &info))
+    {
+        memset(&info, 0, sizeof(info));
+        detectStaticInfo(&info);
+        if(hasBootId)
+            ffCacheWrite(instance, "cpu-static", sizeof(bootId), bootId, sizeof(info), &info);
+    }
+
+    ffStrbufAppendS(&cpu->name, info.name);
+    ffStrbufAppendS(&cpu->vendor, info.vendor);
+    cpu->coresPhysical = info.coresPhysical;
+    cpu->packages = info.packages;
+    cpu->clusterCount = info.clusterCount;
+    memcpy(cpu->clusters, info.clusters, sizeof(cpu->clusters));
+    cpu->frequencyMin = info.frequencyMin;
+    cpu->frequencyMax = info.frequencyMax;
+}
@@ -5,40 +5,84 @@
 
 #include <stdint.h>
 
-// We need to use uint64_t because sizeof(long) == 4 on Windows
-const char* ffGetCpuUsageInfo(uint64_t* inUseAll, uint64_t* totalAll);
+// Appends one FFCpuUsageInfo per core. If the platform can't report single cores, one entry for all of them is added
+const char* ffGetCpuUsageInfo(FFlist* cpuTimes /* list of FFCpuUsageInfo */);
 
-static uint64_t inUseAll1, totalAll1;
+static FFlist cpuTimes1;
+static uint64_t startTime;
 
 void ffPrepareCPUUsage()
 {
-    ffGetCpuUsageInfo(&inUseAll1, &totalAll1);
+    ffListInit(&cpuTimes1, sizeof(FFCpuUsageInfo));
+    if(ffGetCpuUsageInfo(&cpuTimes1) == NULL)
+        startTime = ffTimeGetTick();
 }
 
-const char* ffGetCpuUsageResult(double* result)
+static FFCpuUsageInfo sumCpuTimes(const FFlist* cpuTimes)
+{
+    FFCpuUsageInfo sum = {0};
+    FF_LIST_FOR_EACH(FFCpuUsageInfo, info, *cpuTimes)
+    {
+        sum.inUseAll += info->inUseAll;
+        sum.totalAll += info->totalAll;
+    }
+    return sum;
+}
+
+static double calcUsage(const FFCpuUsageInfo* info1, const FFCpuUsageInfo* info2)
+{
+    if(info2->totalAll <= info1->totalAll)
+        return 0;
+    return (double)(info2->inUseAll - info1->inUseAll) / (double)(info2->totalAll - info1->totalAll) * 100;
+}
+
+const char* ffGetCpuUsageResult(uint32_t minInterval, double* result, FFlist* cores)
 {
     const char* error = NULL;
-    if(inUseAll1 == 0 && totalAll1 == 0)
+    if(startTime == 0)
     {
-        error = ffGetCpuUsageInfo(&inUseAll1, &totalAll1);
+        //Not prepared. Behave as if we were prepared just now
+        ffListDestroy(&cpuTimes1);
+        ffListInit(&cpuTimes1, sizeof(FFCpuUsageInfo));
+        error = ffGetCpuUsageInfo(&cpuTimes1);
         if(error)
             return error;
-        ffTimeSleep(200);
+        startTime = ffTimeGetTick();
     }
 
+    uint64_t elapsed = ffTimeGetTick() - startTime;
+    if(elapsed < minInterval)
+        ffTimeSleep((uint32_t) (minInterval - elapsed));
+
+    FFCpuUsageInfo sum1 = sumCpuTimes(&cpuTimes1);
+
+    FF_LIST_AUTO_DESTROY cpuTimes2;
+    ffListInit(&cpuTimes2, sizeof(FFCpuUsageInfo));
+
     while(true)
     {
-        uint64_t inUseAll2, totalAll2;
-        error = ffGetCpuUsageInfo(&inUseAll2, &totalAll2);
+        cpuTimes2.length = 0;
+        error = ffGetCpuUsageInfo(&cpuTimes2);
         if(error)
             return error;
 
-        if(inUseAll2 != inUseAll1)
+        FFCpuUsageInfo sum2 = sumCpuTimes(&cpuTimes2);
+        if(sum2.totalAll != sum1.totalAll)
         {
-            *result = (double)(inUseAll2 - inUseAll1) / (double)(totalAll2 - totalAll1) * 100;
-            return NULL;
+            *result = calcUsage(&sum1, &sum2);
+            break;
         }
-        else
-            ffTimeSleep(200);
+
+        //The counters have a resolution of one scheduler tick (usually 10ms)
+        ffTimeSleep(10);
     }
+
+    //CPUs may go on- or offline between the samples. Per core values are meaningless then
+    if(cores != NULL && cpuTimes1.length == cpuTimes2.length)
+    {
+        for(uint32_t i = 0; i < cpuTimes2.length; ++i)
+            *(double*) ffListAdd(cores) = calcUsage(ffListGet(&cpuTimes1, i), ffListGet(&cpuTimes2, i));
+    }
+
+    return NULL;
 }
@@ -3,6 +3,24 @@
 #ifndef FF_INCLUDED_detection_cpu_cpuUsage
 #define FF_INCLUDED_detection_cpu_cpuUsage
 
-const char* ffGetCpuUsageResult(double* result);
+#include "fastfetch.h"
+
+typedef struct FFCpuUsageInfo
+{
+    // We need to use uint64_t because sizeof(long) == 4 on Windows
+    uint64_t inUseAll;
+    uint64_t totalAll;
+} FFCpuUsageInfo;
+
+/**
+ * Computes the CPU usage since ffPrepareCPUUsage() was called.
+ * Waits only for the part of minInterval (ms) that has not already elapsed.
+ *
+ * @param minInterval the minimum sampling window in milliseconds
+ * @param result the usage of all cores in percent
+ * @param cores list of double, the usage of every core in percent. May be NULL
+ * @return NULL on success, an error message otherwise
+ */
+const char* ffGetCpuUsageResult(uint32_t minInterval, double* result, FFlist* cores);
 
 #endif
@@ -3,21 +3,28 @@
 
 #include <mach/processor_info.h>
 #include <mach/mach_host.h>
+#include <mach/mach_init.h>
+#include <mach/vm_map.h>
 
-const char* ffGetCpuUsageInfo(uint64_t* inUseAll, uint64_t* totalAll)
+const char* ffGetCpuUsageInfo(FFlist* cpuTimes /* list of FFCpuUsageInfo */)
 {
-	host_cpu_load_info_data_t cpustats;
-	mach_msg_type_number_t count = HOST_CPU_LOAD_INFO_COUNT;
+    natural_t numCPUs;
+    processor_cpu_load_info_t cpuLoad;
+    mach_msg_type_number_t cpuMsgCount;
 
-    *inUseAll = *totalAll = 0;
+    if (host_processor_info(mach_host_self(), PROCESSOR_CPU_LOAD_INFO, &numCPUs, (processor_info_array_t*)&cpuLoad, &cpuMsgCount) != KERN_SUCCESS)
+        return "host_processor_info() failed";
 
-    if (host_statistics(mach_host_self(), HOST_CPU_LOAD_INFO, (host_info_t)(&cpustats), &count) != KERN_SUCCESS)
-        return "host_statistics() failed";
+    for (natural_t i = 0; i < numCPUs; ++i)
+    {
+        FFCpuUsageInfo* info = ffListAdd(cpuTimes);
+        info->inUseAll = cpuLoad[i].cpu_ticks[CPU_STATE_USER]
+            + cpuLoad[i].cpu_ticks[CPU_STATE_SYSTEM]
+            + cpuLoad[i].cpu_ticks[CPU_STATE_NICE];
+        info->totalAll = info->inUseAll + cpuLoad[i].cpu_ticks[CPU_STATE_IDLE];
+    }
 
-    *inUseAll = cpustats.cpu_ticks[CPU_STATE_USER]
-        + cpustats.cpu_ticks[CPU_STATE_SYSTEM]
-        + cpustats.cpu_ticks[CPU_STATE_NICE];
-    *totalAll = *inUseAll + cpustats.cpu_ticks[CPU_STATE_IDLE];
+    vm_deallocate(mach_task_self(), (vm_address_t)cpuLoad, cpuMsgCount * sizeof(integer_t));
 
     return NULL;
 }
@@ -1,19 +1,29 @@
+#include "fastfetch.h"
 #include "cpuUsage.h"
+#include "util/mallocHelper.h"
 
 #include <sys/types.h>
 #include <sys/user.h>
 #include <sys/sysctl.h>
 
-const char* ffGetCpuUsageInfo(uint64_t* inUseAll, uint64_t* totalAll)
+const char* ffGetCpuUsageInfo(FFlist* cpuTimes /* list of FFCpuUsageInfo */)
 {
-    // interrupt processing, user processes, system processing, lock spinning, and idling
-    uint64_t cpTime[5];
-    size_t neededLength = sizeof(cpTime);
-    if(sysctlbyname("kern.cp_time", cpTime, &neededLength, NULL, 0) != 0)
-        return "sysctlbyname(kern.cp_time) failed";
+    // Per core: interrupt processing, user processes, system processing, lock spinning, and idling
+    size_t neededLength = 0;
+    if(sysctlbyname("kern.cp_times", NULL, &neededLength, NULL, 0) != 0 || neededLength == 0)
+        return "sysctlbyname(kern.cp_times, NULL) failed";
 
-    *inUseAll = cpTime[0] + cpTime[1] + cpTime[2] + cpTime[3];
-    *totalAll = *inUseAll + cpTime[4];
+    uint64_t* FF_AUTO_FREE cpTimes = malloc(neededLength);
+    if(sysctlbyname("kern.cp_times", cpTimes, &neededLength, NULL, 0) != 0)
+        return "sysctlbyname(kern.cp_times, cpTimes) failed";
+
+    for(size_t i = 0; i < neededLength / (sizeof(uint64_t) * 5); ++i)
+    {
+        const uint64_t* cpTime = cpTimes + i * 5;
+        FFCpuUsageInfo* info = ffListAdd(cpuTimes);
+        info->inUseAll = cpTime[0] + cpTime[1] + cpTime[2] + cpTime[3];
+        info->totalAll = info->inUseAll + cpTime[4];
+    }
 
     return NULL;
 }
@@ -1,32 +1,84 @@
 #include "fastfetch.h"
 #include "cpuUsage.h"
 
-#include <stdio.h>
-#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
 
-const char* ffGetCpuUsageInfo(uint64_t* inUseAll, uint64_t* totalAll)
+static inline uint64_t parseUInt64(const char** str)
 {
-    uint64_t user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0;
+    const char* p = *str;
+    while(*p == ' ')
+        ++p;
 
-    FILE* procStat = fopen("/proc/stat", "r");
-    if(procStat == NULL)
+    uint64_t value = 0;
+    while(*p >= '0' && *p <= '9')
+        value = value * 10 + (uint64_t) (*p++ - '0');
+
+    *str = p;
+    return value;
+}
+
+const char* ffGetCpuUsageInfo(FFlist* cpuTimes /* list of FFCpuUsageInfo */)
+{
+    //Kept open for the lifetime of the process, so that every sample is a single pread
+    static int procStat = -1;
+    static FFstrbuf buffer;
+
+    if(procStat < 0)
+    {
+        procStat = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+        if(procStat < 0)
+        {
+            #ifdef __ANDROID__
+            return "Accessing \"/proc/stat\" is restricted on Android O+";
+            #else
+            return "open(\"/proc/stat\", O_RDONLY) failed";
+            #endif
+        }
+        ffStrbufInitA(&buffer, 4096);
+    }
+
+    //The cpu lines are at the start of the file. Grow until the buffer holds all of them and the line after
+    ssize_t readed;
+    while(true)
     {
-        #ifdef __ANDROID__
-        return "Accessing \"/proc/stat\" is restricted on Android O+";
-        #else
-        return "fopen(\"""/proc/stat\", \"r\") == NULL";
-        #endif
+        readed = pread(procStat, buffer.chars, buffer.allocated - 1, 0);
+        if(readed <= 0)
+            return "pread(\"/proc/stat\") failed";
+
+        buffer.length = (uint32_t) readed;
+        buffer.chars[buffer.length] = '\0';
+
+        if(buffer.length < buffer.allocated - 1 || strstr(buffer.chars, "\nintr") != NULL)
+            break;
+
+        ffStrbufEnsureFree(&buffer, buffer.allocated);
     }
 
-    if (fscanf(procStat, "cpu%" PRIu64 "%" PRIu64 "%" PRIu64 "%" PRIu64 "%" PRIu64 "%" PRIu64 "%" PRIu64, &user, &nice, &system, &idle, &iowait, &irq, &softirq) < 0)
+    //The first line is the sum of all cores, skip it
+    const char* line = strchr(buffer.chars, '\n');
+    while(line != NULL && strncmp(line + 1, "cpu", 3) == 0)
     {
-        fclose(procStat);
-        return "fscanf() failed";
+        const char* p = line + 4;
+        parseUInt64(&p); // Core index
+
+        uint64_t user = parseUInt64(&p);
+        uint64_t nice = parseUInt64(&p);
+        uint64_t system = parseUInt64(&p);
+        uint64_t idle = parseUInt64(&p);
+        uint64_t iowait = parseUInt64(&p);
+        uint64_t irq = parseUInt64(&p);
+        uint64_t softirq = parseUInt64(&p);
+
+        FFCpuUsageInfo* info = ffListAdd(cpuTimes);
+        info->inUseAll = user + nice + system;
+        info->totalAll = info->inUseAll + idle + iowait + irq + softirq;
+
+        line = strchr(p, '\n');
     }
-    *inUseAll = user + nice + system;
-    *totalAll = *inUseAll + idle + iowait + irq + softirq;
 
-    fclose(procStat);
+    if(cpuTimes->length == 0)
+        return "No cpu lines found in \"/proc/stat\"";
 
     return NULL;
 }
@@ -8,7 +8,7 @@
 #include <ntstatus.h>
 #include <winternl.h>
 
-const char* ffGetCpuUsageInfo(uint64_t* inUseAll, uint64_t* totalAll)
+const char* ffGetCpuUsageInfo(FFlist* cpuTimes /* list of FFCpuUsageInfo */)
 {
     ULONG size = 0;
     if(NtQuerySystemInformation(SystemProcessorPerformanceInformation, NULL, 0, &size) != STATUS_INFO_LENGTH_MISMATCH)
@@ -18,8 +18,6 @@ const char* ffGetCpuUsageInfo(uint64_t* inUseAll, uint64_t* totalAll)
     if(!NT_SUCCESS(NtQuerySystemInformation(SystemProcessorPerformanceInformation, pinfo, size, &size)))
         return "NtQuerySystemInformation(SystemProcessorPerformanceInformation, size) failed";
 
-    *inUseAll = *totalAll = 0;
-
     for (uint32_t i = 0; i < size / sizeof(SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION); ++i)
     {
         SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION* coreInfo = pinfo + i;
@@ -31,8 +29,9 @@ const char* ffGetCpuUsageInfo(uint64_t* inUseAll, uint64_t* totalAll)
         coreInfo->KernelTime.QuadPart += dpcTime + interruptTime;
 
         LONGLONG inUse = coreInfo->UserTime.QuadPart + coreInfo->KernelTime.QuadPart;
-        *inUseAll += (uint64_t)inUse;
-        *totalAll += (uint64_t)(inUse + coreInfo->IdleTime.QuadPart);
+        FFCpuUsageInfo* info = (FFCpuUsageInfo*) ffListAdd(cpuTimes);
+        info->inUseAll = (uint64_t)inUse;
+        info->totalAll = (uint64_t)(inUse + coreInfo->IdleTime.QuadPart);
     }
 
     return NULL;
@@ -46,7 +45,7 @@ static inline uint64_t fileTimeToUint64(const FILETIME* ft) {
     return (((uint64_t)ft->dwHighDateTime) << 32) | ((uint64_t)ft->dwLowDateTime);
 }
 
-const char* ffGetCpuUsageInfo(uint64_t* inUseAll, uint64_t* totalAll)
+const char* ffGetCpuUsageInfo(FFlist* cpuTimes /* list of FFCpuUsageInfo */)
 {
     FILETIME idleTime, kernelTime, userTime;
     if(!GetSystemTimes(&idleTime, &kernelTime, &userTime))
@@ -54,8 +53,9 @@ const char* ffGetCpuUsageInfo(uint64_t* inUseAll, uint64_t* totalAll)
 
     // https://learn.microsoft.com/en-us/windows/win32/api/processthreadsapi/nf-processthreadsapi-getsystemtimes
     // `kernelTime` also includes the amount of time the system has been idle.
-    *totalAll = fileTimeToUint64(&userTime) + fileTimeToUint64(&kernelTime);
-    *inUseAll = *totalAll - fileTimeToUint64(&idleTime);
+    FFCpuUsageInfo* info = (FFCpuUsageInfo*) ffListAdd(cpuTimes);
+    info->totalAll = fileTimeToUint64(&userTime) + fileTimeToUint64(&kernelTime);
+    info->inUseAll = info->totalAll - fileTimeToUint64(&idleTime);
     return NULL;
 }
 
@@ -1,9 +1,8 @@
 #include "disk.h"
 
+#include "common/io/io.h"
 #include "util/stringUtils.h"
 
-#include <limits.h>
-#include <ctype.h>
 #include <dirent.h>
 #include <sys/stat.h>
 #include <sys/statvfs.h>
@@ -15,67 +14,75 @@
     #define readdir readdir64
 #endif
 
-static bool isPhysicalDevice(FFstrbuf* device)
+static bool isPhysicalDevice(const char* device)
 {
-    struct stat deviceStat;
-    if(stat(device->chars, &deviceStat) != 0)
-        return false;
-
-    //Ignore all devices that are not block devices
-    if(!S_ISBLK(deviceStat.st_mode))
-        return false;
-
-    //Ignore all devices that are not physical devices
-
-
     //DrvFs is a filesystem plugin to WSL that was designed to support interop between WSL and the Windows filesystem.
-    if(ffStrbufEqualS(device, "drvfs"))
-        return true;
-
     //ZFS root pool. The format is rpool/<POOL_NAME>/<VOLUME_NAME>/<SUBVOLUME_NAME>
-    if(ffStrbufStartsWithS(device, "rpool/"))
-        return true;
+    bool special = strcmp(device, "drvfs") == 0 || strncmp(device, "rpool/", 6) == 0;
 
     //Pseudo filesystems don't have a device in /dev
-    if(!ffStrbufStartsWithS(device, "/dev/"))
+    if(!special && strncmp(device, "/dev/", 5) != 0)
         return false;
 
     if(
-        ffStrbufStartsWithS(device, "/dev/loop") || //Ignore loop devices
-        ffStrbufStartsWithS(device, "/dev/ram")  || //Ignore ram devices
-        ffStrbufStartsWithS(device, "/dev/fd")      //Ignore fd devices
+        strncmp(device, "/dev/loop", 9) == 0 || //Ignore loop devices
+        strncmp(device, "/dev/ram", 8) == 0  || //Ignore ram devices
+        strncmp(device, "/dev/fd", 7) == 0      //Ignore fd devices
     ) return false;
 
-    return true;
+    //Only now pay for the syscall. Ignore all devices that are not block devices
+    struct stat deviceStat;
+    if(stat(device, &deviceStat) != 0)
+        return false;
+
+    return S_ISBLK(deviceStat.st_mode);
 }
 
-static void appendNextEntry(FFstrbuf* buffer, char** source)
+//Splits the next space separated field of a mountinfo line in place. Returns NULL at the end of the line.
+static char* nextField(char** source)
 {
-    //Read the current entry into the buffer
-    while(**source != '\0' && !isspace(**source))
+    char* start = *source;
+    while(*start == ' ')
+        ++start;
+
+    if(*start == '\0' || *start == '\n')
+        return NULL;
+
+    char* end = start;
+    while(*end != '\0' && *end != ' ' && *end != '\n')
+        ++end;
+
+    if(*end != '\0')
+        *end++ = '\0';
+
+    *source = end;
+    return start;
+}
+
+//The kernel escapes space, tab, newline and backslash as \ooo. Decoding never makes the string longer, so it is done in place.
+static uint32_t unescapeField(char* field)
+{
+    char* dst = strchr(field, '\\');
+    if(dst == NULL)
+        return (uint32_t) strlen(field);
+
+    const char* src = dst;
+    while(*src != '\0')
     {
-        //After a backslash the next 3 characters are octal ascii codes
-        if(**source == '\\' && strnlen(*source, 4) == 4)
-        {
-            char octal[4] = {0};
-            strncpy(octal, *source + 1, 3);
-
-            long value = strtol(octal, NULL, 8); //Returns 0 on error, so no need to check endptr
-            if(value > 0 && value < CHAR_MAX)
-            {
-                ffStrbufAppendC(buffer, (char) value);
-                *source += 4;
-                continue;
-            }
+        if(src[0] == '\\' &&
+            src[1] >= '0' && src[1] <= '3' &&
+            src[2] >= '0' && src[2] <= '7' &&
+            src[3] >= '0' && src[3] <= '7'
+        ) {
+            *dst++ = (char) (((src[1] - '0') << 6) | ((src[2] - '0') << 3) | (src[3] - '0'));
+            src += 4;
         }
-
-        ffStrbufAppendC(buffer, **source);
-        ++*source;
+        else
+            *dst++ = *src++;
     }
+    *dst = '\0';
 
-    //Skip whitespace
-    while(isspace(**source))
-        ++*source;
+    return (uint32_t) (dst - field);
 }
 
 static void detectNameFromPath(FFDisk* disk, const struct stat* deviceStat, FFstrbuf* basePath)
@@ -109,10 +116,10 @@ static void detectNameFromPath(FFDisk* disk, const struct stat* deviceStat, FFst
     closedir(dir);
 }
 
-static void detectName(FFDisk* disk, const FFstrbuf* device)
+static void detectName(FFDisk* disk, const char* device)
 {
     struct stat deviceStat;
-    if(stat(device->chars, &deviceStat) != 0)
+    if(stat(device, &deviceStat) != 0)
         return;
 
     FFstrbuf basePath;
@@ -138,7 +145,7 @@ static void detectName(FFDisk* disk, const FFstrbuf* device)
 
 #ifdef __ANDROID__
 
-static void detectType(FF_MAYBE_UNUSED const FFlist* devices, FFDisk* currentDisk, FF_MAYBE_UNUSED const char* options)
+static void detectType(FF_MAYBE_UNUSED bool seen, FFDisk* currentDisk, FF_MAYBE_UNUSED const char* device, FF_MAYBE_UNUSED const char* options)
 {
     if(ffStrbufEqualS(&currentDisk->mountpoint, "/") || ffStrbufEqualS(&currentDisk->mountpoint, "/storage/emulated"))
         currentDisk->type = FF_DISK_TYPE_REGULAR;
@@ -150,30 +157,23 @@ static void detectType(FF_MAYBE_UNUSED const FFlist* devices, FFDisk* currentDis
 
 #else
 
-static bool isSubvolume(const FFlist* devices)
+static bool isSubvolume(bool seen, const char* device)
 {
-    const FFstrbuf* currentDevie = ffListGet(devices, devices->length - 1);
-
-    //Filter all disks which device was already found. This catches BTRFS subvolumes.
-    for(uint32_t i = 0; i < devices->length - 1; i++)
-    {
-        const FFstrbuf* otherDevice = ffListGet(devices, i);
-
-        if(ffStrbufEqual(currentDevie, otherDevice))
-            return true;
-    }
+    //Filter all disks which device or major:minor was already found. This catches BTRFS subvolumes and bind mounts.
+    if(seen)
+        return true;
 
     //ZFS subvolumes: rpool/<POOL_NAME>/<VOLUME_NAME>/<SUBVOLUME_NAME>.
     //Test if the third slash is present.
-    if(strncmp(currentDevie->chars, "rpool/", 6) == 0 && ffStrHasNChars(currentDevie->chars, '/', 3))
+    if(strncmp(device, "rpool/", 6) == 0 && ffStrHasNChars(device, '/', 3))
         return true;
 
     return false;
 }
 
-static void detectType(const FFlist* devices, FFDisk* currentDisk, const char* options)
+static void detectType(bool seen, FFDisk* currentDisk, const char* device, const char* options)
 {
-    if(isSubvolume(devices))
+    if(isSubvolume(seen, device))
         currentDisk->type = FF_DISK_TYPE_SUBVOLUME;
     else if(strstr(options, "nosuid") != NULL || strstr(options, "nodev") != NULL)
         currentDisk->type = FF_DISK_TYPE_EXTERNAL;
@@ -198,66 +198,115 @@ static void detectStats(FFDisk* disk)
     disk->filesUsed = (uint32_t) (disk->filesTotal - fs.f_ffree);
 }
 
+//Open addressing set of strings pointing into the mountinfo buffer. Used to find devices that are mounted more than once.
+typedef struct SeenSet
+{
+    const char** keys;
+    uint32_t mask;
+} SeenSet;
+
+static void seenSetInit(SeenSet* set, uint32_t expected)
+{
+    uint32_t capacity = 16;
+    while(capacity < expected * 2)
+        capacity *= 2;
+
+    set->keys = calloc(capacity, sizeof(*set->keys));
+    set->mask = capacity - 1;
+}
+
+//Returns true if the key was already present
+static bool seenSetInsert(SeenSet* set, const char* key)
+{
+    uint32_t hash = 2166136261u; //FNV-1a
+    for(const char* p = key; *p; ++p)
+        hash = (hash ^ (uint8_t) *p) * 16777619u;
+
+    for(uint32_t i = hash & set->mask;; i = (i + 1) & set->mask)
+    {
+        if(set->keys[i] == NULL)
+        {
+            set->keys[i] = key;
+            return false;
+        }
+        if(strcmp(set->keys[i], key) == 0)
+            return true;
+    }
+}
+
 void ffDetectDisksImpl(FFDiskResult* disks)
 {
-    FILE* mountsFile = fopen("/proc/mounts", "r");
-    if(mountsFile == NULL)
+    FF_STRBUF_AUTO_DESTROY mountinfo;
+    ffStrbufInitA(&mountinfo, 0);
+    if(!ffAppendFileBuffer("/proc/self/mountinfo", &mountinfo) || mountinfo.length == 0)
     {
-        ffStrbufAppendS(&disks->error, "fopen(\"/proc/mounts\", \"r\") == NULL");
+        ffStrbufAppendS(&disks->error, "ffAppendFileBuffer(\"/proc/self/mountinfo\") failed");
         return;
     }
 
-    FFlist devices;
-    ffListInit(&devices, sizeof(FFstrbuf));
-
-    char* line = NULL;
-    size_t len = 0;
+    //Each line ends with a newline, so this is the number of mounts. Every mount can add at most one key to each set.
+    uint32_t lineCount = ffStrbufCountC(&mountinfo, '\n') + 1;
+    SeenSet devices, deviceIds;
+    seenSetInit(&devices, lineCount);
+    seenSetInit(&deviceIds, lineCount);
 
-    while(getline(&line, &len, mountsFile) != EOF)
+    char* line = mountinfo.chars;
+    while(*line != '\0')
     {
-        //Format of the file: "<device> <mountpoint> <filesystem> <options> ..." (Same as fstab)
+        char* lineEnd = strchr(line, '\n');
+        if(lineEnd != NULL)
+            *lineEnd = '\0';
+        char* nextLine = lineEnd != NULL ? lineEnd + 1 : line + strlen(line);
+
+        //Format of the file: "<id> <parentId> <major:minor> <root> <mountpoint> <options> [optional fields...] - <filesystem> <device> <superOptions>"
         char* currentPos = line;
+        line = nextLine;
+
+        nextField(&currentPos); //id
+        nextField(&currentPos); //parentId
+        char* deviceId = nextField(&currentPos);
+        nextField(&currentPos); //root
+        char* mountpoint = nextField(&currentPos);
+        char* options = nextField(&currentPos);
+        if(options == NULL)
+            continue;
 
-        //detect device
-        FFstrbuf* device = ffListAdd(&devices);
-        ffStrbufInit(device);
-        appendNextEntry(device, &currentPos);
+        char* field;
+        while((field = nextField(&currentPos)) != NULL && strcmp(field, "-") != 0);
 
+        char* filesystem = nextField(&currentPos);
+        char* device = nextField(&currentPos);
+        if(device == NULL)
+            continue;
+
+        unescapeField(device);
         if(!isPhysicalDevice(device))
-        {
-            ffStrbufDestroy(device);
-            devices.length--;
             continue;
-        }
+
+        //Insert into both sets unconditionally, so that later mounts of either see this one
+        bool seen = seenSetInsert(&devices, device);
+        seen = seenSetInsert(&deviceIds, deviceId) || seen;
 
         //We have a valid device, add it to the list
         FFDisk* disk = ffListAdd(&disks->disks);
 
         //detect mountpoint
-        ffStrbufInit(&disk->mountpoint);
-        appendNextEntry(&disk->mountpoint, &currentPos);
+        ffStrbufInitNS(&disk->mountpoint, unescapeField(mountpoint), mountpoint);
 
         //detect filesystem
-        ffStrbufInit(&disk->filesystem);
-        appendNextEntry(&disk->filesystem, &currentPos);
+        ffStrbufInitNS(&disk->filesystem, unescapeField(filesystem), filesystem);
 
         //detect name
         ffStrbufInit(&disk->name);
         detectName(disk, device);
 
         //detect type
-        detectType(&devices, disk, currentPos);
+        detectType(seen, disk, device, options);
 
         //Detects stats
         detectStats(disk);
     }
 
-    if(line != NULL)
-        free(line);
-
-    FF_LIST_FOR_EACH(FFstrbuf, device, devices)
-        ffStrbufDestroy(device);
-    ffListDestroy(&devices);
-
-    fclose(mountsFile);
+    free(devices.keys);
+    free(deviceIds.keys);
 }
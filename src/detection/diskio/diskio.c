@@ -0,0 +1,90 @@
+#include "fastfetch.h"
+#include "diskio.h"
+
+#include "common/time.h"
+
+const char* ffDiskIOGetSample(FFlist* samples /* list of FFDiskIOSample */);
+
+static FFlist samples1;
+static uint64_t time1;
+
+void ffPrepareDiskIO()
+{
+    ffListInit(&samples1, sizeof(FFDiskIOSample));
+    if(ffDiskIOGetSample(&samples1) == NULL)
+        time1 = ffTimeGetTick();
+}
+
+static const FFDiskIOSample* findSample(const FFlist* samples, uint32_t hint, const char* name)
+{
+    //The kernel keeps the order stable, so the same index usually matches
+    if(hint < samples->length)
+    {
+        const FFDiskIOSample* sample = ffListGet(samples, hint);
+        if(strcmp(sample->name, name) == 0)
+            return sample;
+    }
+
+    FF_LIST_FOR_EACH(FFDiskIOSample, sample, *samples)
+    {
+        if(strcmp(sample->name, name) == 0)
+            return sample;
+    }
+    return NULL;
+}
+
+const char* ffDetectDiskIO(FFlist* result /* list of FFDiskIOResult */)
+{
+    const char* error = NULL;
+    if(time1 == 0)
+    {
+        //Not prepared, we have to wait for a sample window ourselves
+        ffListDestroy(&samples1);
+        ffListInit(&samples1, sizeof(FFDiskIOSample));
+        error = ffDiskIOGetSample(&samples1);
+        if(error)
+            return error;
+        time1 = ffTimeGetTick();
+        ffTimeSleep(200);
+    }
+
+    uint64_t time2 = ffTimeGetTick();
+    if(time2 == time1)
+    {
+        ffTimeSleep(1);
+        time2 = ffTimeGetTick();
+    }
+
+    FF_LIST_AUTO_DESTROY samples2;
+    ffListInit(&samples2, sizeof(FFDiskIOSample));
+    error = ffDiskIOGetSample(&samples2);
+    if(error)
+        return error;
+
+    uint64_t elapsed = time2 - time1;
+
+    for(uint32_t i = 0; i < samples2.length; ++i)
+    {
+        const FFDiskIOSample* sample2 = ffListGet(&samples2, i);
+        const FFDiskIOSample* sample1 = findSample(&samples1, i, sample2->name);
+        if(sample1 == NULL)
+            continue;
+
+        //The counters went backwards, e.g. the device was removed and re-added with the same name between the samples
+        if(
+            sample2->bytesRead < sample1->bytesRead ||
+            sample2->bytesWritten < sample1->bytesWritten ||
+            sample2->readCount < sample1->readCount ||
+            sample2->writeCount < sample1->writeCount
+        ) continue;
+
+        FFDiskIOResult* device = ffListAdd(result);
+        ffStrbufInitS(&device->name, sample2->name);
+        device->bytesReadPerSec = (sample2->bytesRead - sample1->bytesRead) * 1000 / elapsed;
+        device->bytesWrittenPerSec = (sample2->bytesWritten - sample1->bytesWritten) * 1000 / elapsed;
+        device->readsPerSec = (sample2->readCount - sample1->readCount) * 1000 / elapsed;
+        device->writesPerSec = (sample2->writeCount - sample1->writeCount) * 1000 / elapsed;
+    }
+
+    return NULL;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#ifndef FF_INCLUDED_detection_diskio_diskio
+#define FF_INCLUDED_detection_diskio_diskio
+
+#include "fastfetch.h"
+
+typedef struct FFDiskIOSample
+{
+    char name[32];
+    uint64_t bytesRead;
+    uint64_t bytesWritten;
+    uint64_t readCount;
+    uint64_t writeCount;
+} FFDiskIOSample;
+
+typedef struct FFDiskIOResult
+{
+    FFstrbuf name;
+    uint64_t bytesReadPerSec;
+    uint64_t bytesWrittenPerSec;
+    uint64_t readsPerSec;
+    uint64_t writesPerSec;
+} FFDiskIOResult;
+
+const char* ffDetectDiskIO(FFlist* result /* list of FFDiskIOResult */);
+
+#endif
@@ -0,0 +1,48 @@
+#include "diskio.h"
+#include "common/io/io.h"
+
+#include <inttypes.h>
+
+const char* ffDiskIOGetSample(FFlist* samples /* list of FFDiskIOSample */)
+{
+    FF_STRBUF_AUTO_DESTROY content;
+    ffStrbufInit(&content);
+    if(!ffAppendFileBuffer("/proc/diskstats", &content))
+        return "ffAppendFileBuffer(\"/proc/diskstats\") failed";
+
+    char path[64] = "/sys/block/";
+    const uint32_t pathBaseLength = (uint32_t) strlen(path);
+
+    const char* line = content.chars;
+    while(*line != '\0')
+    {
+        //Format: "<major> <minor> <name> <reads> <readsMerged> <sectorsRead> <msReading> <writes> <writesMerged> <sectorsWritten> ..."
+        FFDiskIOSample sample;
+        uint64_t sectorsRead, sectorsWritten;
+        int matched = sscanf(line, "%*u %*u %31s %" SCNu64 " %*u %" SCNu64 " %*u %" SCNu64 " %*u %" SCNu64,
+            sample.name, &sample.readCount, &sectorsRead, &sample.writeCount, &sectorsWritten);
+
+        const char* lineEnd = strchr(line, '\n');
+        line = lineEnd ? lineEnd + 1 : line + strlen(line);
+
+        if(matched != 5)
+            continue;
+
+        //Virtual devices: loop devices like the disk module, plus ram disks, floppies and compressed swap in RAM
+        if(strncmp(sample.name, "loop", 4) == 0 || strncmp(sample.name, "ram", 3) == 0 || strncmp(sample.name, "fd", 2) == 0 || strncmp(sample.name, "zram", 4) == 0)
+            continue;
+
+        //Only whole disks have an entry in /sys/block, partitions are skipped
+        strcpy(path + pathBaseLength, sample.name);
+        if(!ffPathExists(path, FF_PATHTYPE_DIRECTORY))
+            continue;
+
+        //Sectors in /proc/diskstats are always 512 bytes, regardless of the hardware
+        sample.bytesRead = sectorsRead * 512;
+        sample.bytesWritten = sectorsWritten * 512;
+
+        *(FFDiskIOSample*) ffListAdd(samples) = sample;
+    }
+
+    return NULL;
+}
@@ -0,0 +1,6 @@
+#include "diskio.h"
+
+const char* ffDiskIOGetSample(FF_MAYBE_UNUSED FFlist* samples /* list of FFDiskIOSample */)
+{
+    return "Not supported on this platform";
+}
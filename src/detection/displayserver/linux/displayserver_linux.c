@@ -1,5 +1,7 @@
 #include "displayserver_linux.h"
+#include "common/thread.h"
 
+#include <stdlib.h>
 #include <dirent.h>
 
 static void parseDRM(FFDisplayServerResult* result)
@@ -51,7 +53,7 @@ static void parseDRM(FFDisplayServerResult* result)
     ffStrbufDestroy(&drmDir);
 }
 
-void ffConnectDisplayServerImpl(FFDisplayServerResult* ds, const FFinstance* instance)
+static void initResult(FFDisplayServerResult* ds)
 {
     ffStrbufInit(&ds->wmProcessName);
     ffStrbufInit(&ds->wmPrettyName);
@@ -60,26 +62,136 @@ void ffConnectDisplayServerImpl(FFDisplayServerResult* ds, const FFinstance* ins
     ffStrbufInit(&ds->dePrettyName);
     ffStrbufInit(&ds->deVersion);
     ffListInitA(&ds->displays, sizeof(FFDisplayResult), 4);
+}
 
-    //We try wayland as our prefered display server, as it supports the most features.
-    //This method can't detect the name of our WM / DE
-    ffdsConnectWayland(instance, ds);
+typedef struct X11Job
+{
+    const FFinstance* instance;
+    FFDisplayServerResult result;
+    FFThreadMutex mutex;
+    bool cancelled;
+} X11Job;
 
+static bool x11JobCancelled(X11Job* job)
+{
+    if(job == NULL)
+        return false;
+
+    ffThreadMutexLock(&job->mutex);
+    bool cancelled = job->cancelled;
+    ffThreadMutexUnlock(&job->mutex);
+    return cancelled;
+}
+
+static void connectX11(const FFinstance* instance, FFDisplayServerResult* result, X11Job* job)
+{
     //Try the x11 libs, from most feature rich to least.
     //We use the display list to detect if a connection is needed.
     //They respect wmProtocolName, and only detect display if it is set.
+    //Each of them closes its connection before returning, so between them the job can be abandoned safely.
 
-    if(ds->displays.length == 0)
-        ffdsConnectXcbRandr(instance, ds);
+    if(!x11JobCancelled(job))
+        ffdsConnectXcbRandr(instance, result);
 
-    if(ds->displays.length == 0)
-        ffdsConnectXrandr(instance, ds);
+    if(result->displays.length == 0 && !x11JobCancelled(job))
+        ffdsConnectXrandr(instance, result);
 
-    if(ds->displays.length == 0)
-        ffdsConnectXcb(instance, ds);
+    if(result->displays.length == 0 && !x11JobCancelled(job))
+        ffdsConnectXcb(instance, result);
 
-    if(ds->displays.length == 0)
-        ffdsConnectXlib(instance, ds);
+    if(result->displays.length == 0 && !x11JobCancelled(job))
+        ffdsConnectXlib(instance, result);
+}
+
+#ifdef FF_HAVE_THREADS
+
+static void destroyResult(FFDisplayServerResult* ds)
+{
+    ffStrbufDestroy(&ds->wmProcessName);
+    ffStrbufDestroy(&ds->wmPrettyName);
+    ffStrbufDestroy(&ds->wmProtocolName);
+    ffStrbufDestroy(&ds->deProcessName);
+    ffStrbufDestroy(&ds->dePrettyName);
+    ffStrbufDestroy(&ds->deVersion);
+    ffListDestroy(&ds->displays);
+}
+
+static void connectX11Async(X11Job* job)
+{
+    connectX11(job->instance, &job->result, job);
+}
+
+FF_THREAD_ENTRY_DECL_WRAPPER(connectX11Async, X11Job*)
+
+//Moves the x11 result into ds, as if the x11 libs were called after wayland failed
+static void applyX11Result(FFDisplayServerResult* ds, FFDisplayServerResult* x11)
+{
+    FFlist displays = ds->displays;
+    ds->displays = x11->displays;
+    x11->displays = displays;
+
+    //The x11 libs don't detect the WM if wayland already did, or if we are running wayland
+    if(ds->wmProcessName.length == 0 && ffStrbufCompS(&ds->wmProtocolName, FF_WM_PROTOCOL_WAYLAND) != 0)
+        ffStrbufSet(&ds->wmProcessName, &x11->wmProcessName);
+
+    if(ds->wmProtocolName.length == 0)
+        ffStrbufSet(&ds->wmProtocolName, &x11->wmProtocolName);
+}
+
+#endif
+
+void ffConnectDisplayServerImpl(FFDisplayServerResult* ds, const FFinstance* instance)
+{
+    initResult(ds);
+
+    //Wayland requires XDG_RUNTIME_DIR, the x11 libs require DISPLAY.
+    //If both are possible, but this is not a wayland session, connect to them at the same time, instead of waiting for wayland to fail.
+    //In a wayland session DISPLAY may belong to XWayland, which is started on demand by the first connection, so x11 is only tried if wayland fails
+    bool tryWayland = getenv("XDG_RUNTIME_DIR") != NULL;
+    bool tryX11 = getenv("DISPLAY") != NULL;
+
+    const char* sessionType = getenv("XDG_SESSION_TYPE");
+    bool waylandSession = getenv("WAYLAND_DISPLAY") != NULL && sessionType != NULL && strcmp(sessionType, "wayland") == 0;
+
+    #ifdef FF_HAVE_THREADS
+        X11Job* job = NULL;
+        FFThreadType x11Thread = 0;
+        if(tryWayland && tryX11 && !waylandSession)
+        {
+            job = calloc(1, sizeof(X11Job));
+            job->instance = instance;
+            job->mutex = (FFThreadMutex) FF_THREAD_MUTEX_INITIALIZER;
+            initResult(&job->result);
+            x11Thread = ffThreadCreate(connectX11AsyncThreadMain, job);
+        }
+    #endif
+
+    //We try wayland as our prefered display server, as it supports the most features.
+    //This method can't detect the name of our WM / DE
+    if(tryWayland)
+        ffdsConnectWayland(instance, ds);
+
+    #ifdef FF_HAVE_THREADS
+        if(job != NULL)
+        {
+            //Wayland wins if it found displays. The x11 job then stops before its next connection attempt.
+            //It is joined either way, so that it never runs in the x11 libs while they are unloaded at exit
+            ffThreadMutexLock(&job->mutex);
+            job->cancelled = ds->displays.length > 0;
+            ffThreadMutexUnlock(&job->mutex);
+
+            ffThreadJoin(x11Thread);
+            if(ds->displays.length == 0)
+                applyX11Result(ds, &job->result);
+            destroyResult(&job->result);
+            free(job);
+            tryX11 = false;
+        }
+    #endif
+
+    //The x11 libs see the wayland protocol name here, if wayland was detected
+    if(tryX11 && ds->displays.length == 0)
+        connectX11(instance, ds, NULL);
 
     //This display detection method is display server independent.
     //Use it if all connections failed
@@ -7,6 +7,7 @@
 #include "common/library.h"
 #include "common/io/io.h"
 #include "common/thread.h"
+#include "common/proctable.h"
 #include <wayland-client.h>
 #include <sys/socket.h>
 
@@ -37,13 +38,14 @@ static void waylandDetectWM(int fd, FFDisplayServerResult* result)
     if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &ucred, &len) == -1)
         return;
 
-    FFstrbuf procPath;
-    ffStrbufInit(&procPath);
-    ffStrbufAppendF(&procPath, "/proc/%d/cmdline", ucred.pid); //We check the cmdline for the process name, because it is not trimmed.
-    ffReadFileBuffer(procPath.chars, &result->wmProcessName);
-    ffStrbufSubstrBeforeFirstC(&result->wmProcessName, '\0'); //Trim the arguments
+    //The entry is shared with WM / DE detection, which would read the same process otherwise
+    const FFProcessEntry* compositor = ffProcTableGet((uint32_t) ucred.pid);
+    if(compositor == NULL)
+        return;
+
+    //We check the cmdline for the process name, because it is not trimmed.
+    ffStrbufSet(&result->wmProcessName, ffProcTableGetArgv0(compositor));
     ffStrbufSubstrAfterLastC(&result->wmProcessName, '/'); //Trim the path
-    ffStrbufDestroy(&procPath);
 }
 #else
 static void waylandDetectWM(int fd, FFDisplayServerResult* result)
@@ -3,13 +3,16 @@
 #include "common/properties.h"
 #include "common/parsing.h"
 #include "common/processing.h"
+#include "common/proctable.h"
 #include "util/stringUtils.h"
 
 #include <stdlib.h>
-#include <ctype.h>
 #include <string.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 static const char* parseEnv()
 {
@@ -335,73 +338,177 @@ static void getWMProtocolNameFromEnv(FFDisplayServerResult* result)
     }
 }
 
-static void getFromProcDir(const FFinstance* instance, FFDisplayServerResult* result)
+static bool checkProcess(const FFinstance* instance, FFDisplayServerResult* result, const FFProcessEntry* entry, uint32_t userID)
 {
-    DIR* proc = opendir("/proc");
-    if(proc == NULL)
+    //Don't check for processes not owend by the current user.
+    if(entry->uid != userID)
+        return false;
+
+    //We check the cmdline for the process name, because it is not trimmed.
+    const char* processName = ffProcTableGetArgv0(entry)->chars;
+    const char* slash = strrchr(processName, '/');
+    if(slash != NULL)
+        processName = slash + 1;
+
+    if(result->dePrettyName.length == 0)
+        applyPrettyNameIfDE(instance, result, processName);
+
+    if(result->wmPrettyName.length == 0)
+        applyPrettyNameIfWM(result, processName);
+
+    return result->dePrettyName.length > 0 && result->wmPrettyName.length > 0;
+}
+
+static void appendCgroupPids(int dirfd, FFlist* pids, uint32_t depth)
+{
+    {
+        int FF_AUTO_CLOSE_FD procsfd = openat(dirfd, "cgroup.procs", O_RDONLY | O_CLOEXEC);
+        FF_STRBUF_AUTO_DESTROY content;
+        ffStrbufInit(&content);
+        if(procsfd >= 0 && ffAppendFDBuffer(procsfd, &content))
+        {
+            char* line = content.chars;
+            char* end;
+            uint32_t pid;
+            while((pid = (uint32_t) strtoul(line, &end, 10)) > 0)
+            {
+                *(uint32_t*) ffListAdd(pids) = pid;
+                line = end;
+            }
+        }
+    }
+
+    //Compositors started as systemd user services live in child cgroups of the user slice
+    if(depth == 0)
+        return;
+
+    DIR* dir = fdopendir(dup(dirfd));
+    if(dir == NULL)
         return;
 
-    FFstrbuf procPath;
-    ffStrbufInitA(&procPath, 64);
-    ffStrbufAppendS(&procPath, "/proc/");
+    struct dirent* entry;
+    while((entry = readdir(dir)) != NULL)
+    {
+        if(entry->d_type != DT_DIR || entry->d_name[0] == '.')
+            continue;
 
-    uint32_t procPathLength = procPath.length;
+        int FF_AUTO_CLOSE_FD childfd = openat(dirfd, entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(childfd >= 0)
+            appendCgroupPids(childfd, pids, depth - 1);
+    }
 
-    FFstrbuf userID;
-    ffStrbufInit(&userID);
-    ffStrbufAppendF(&userID, "%i", getuid());
+    closedir(dir);
+}
 
-    FFstrbuf loginuid;
-    ffStrbufInit(&loginuid);
+static void getSessionPids(FFlist* pids)
+{
+    FF_STRBUF_AUTO_DESTROY cgroups;
+    ffStrbufInit(&cgroups);
+    if(!ffAppendFileBuffer("/proc/self/cgroup", &cgroups))
+        return;
 
-    FFstrbuf processName;
-    ffStrbufInitA(&processName, 256); //Some processes have large command lines (looking at you chrome)
+    static const char* const rootsV2[] = { "/sys/fs/cgroup", "/sys/fs/cgroup/unified", NULL };
+    static const char* const rootsV1[] = { "/sys/fs/cgroup/systemd", NULL };
 
-    struct dirent* dirent;
-    while((dirent = readdir(proc)) != NULL)
+    //Lines look like "0::/user.slice/user-1000.slice/session-2.scope" (v2) or "1:name=systemd:/user.slice/..." (v1)
+    char* saveptr = NULL;
+    for(char* line = strtok_r(cgroups.chars, "\n", &saveptr); line != NULL; line = strtok_r(NULL, "\n", &saveptr))
     {
-        //Match only folders starting with a number (the pid folders)
-        if(dirent->d_type != DT_DIR || !isdigit(dirent->d_name[0]))
+        const char* const* roots;
+        if(strncmp(line, "0::/", 4) == 0)
+            roots = rootsV2;
+        else if(strstr(line, ":name=systemd:/") != NULL)
+            roots = rootsV1;
+        else
             continue;
 
-        ffStrbufAppendS(&procPath, dirent->d_name);
-        uint32_t procFolderPathLength = procPath.length;
+        char* path = strchr(strchr(line, ':') + 1, ':') + 1;
 
-        //Don't check for processes not owend by the current user.
-        ffStrbufAppendS(&procPath, "/loginuid");
-        ffReadFileBuffer(procPath.chars, &loginuid);
-        if(ffStrbufComp(&userID, &loginuid) != 0)
-        {
-            ffStrbufSubstrBefore(&procPath, procPathLength);
+        //Widen the session scope to the user slice, which also contains the user services.
+        //Without a user slice (e.g. in containers), the root cgroup would contain all processes, which the fallback handles anyway.
+        char* userSlice = strstr(path, "/user-");
+        if(userSlice == NULL)
             continue;
+        char* sliceEnd = strchr(userSlice + 1, '/');
+        if(sliceEnd != NULL)
+            *sliceEnd = '\0';
+
+        for(; *roots != NULL; ++roots)
+        {
+            FF_STRBUF_AUTO_DESTROY cgroupPath;
+            ffStrbufInitS(&cgroupPath, *roots);
+            ffStrbufAppendS(&cgroupPath, path);
+
+            int FF_AUTO_CLOSE_FD dirfd = open(cgroupPath.chars, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if(dirfd >= 0)
+            {
+                //user-1000.slice/user@1000.service/session.slice/org.gnome.Shell@wayland.service is the deepest common layout
+                appendCgroupPids(dirfd, pids, 4);
+                return;
+            }
         }
+    }
+}
 
-        ffStrbufSubstrBefore(&procPath, procFolderPathLength);
+static uint32_t getWaylandCompositorPid(void)
+{
+    #ifdef SO_PEERCRED
+        const char* display = getenv("WAYLAND_DISPLAY");
+        if(!ffStrSet(display))
+            return 0;
+
+        struct sockaddr_un address = { .sun_family = AF_UNIX };
+        if(display[0] == '/')
+            strncpy(address.sun_path, display, sizeof(address.sun_path) - 1);
+        else
+        {
+            const char* runtimeDir = getenv("XDG_RUNTIME_DIR");
+            if(!ffStrSet(runtimeDir))
+                return 0;
+            snprintf(address.sun_path, sizeof(address.sun_path), "%s/%s", runtimeDir, display);
+        }
 
-        //We check the cmdline for the process name, because it is not trimmed.
-        ffStrbufAppendS(&procPath, "/cmdline");
-        ffReadFileBuffer(procPath.chars, &processName);
-        ffStrbufSubstrBeforeFirstC(&processName, '\0'); //Trim the arguments
-        ffStrbufSubstrAfterLastC(&processName, '/');
+        int FF_AUTO_CLOSE_FD sockfd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(sockfd < 0 || connect(sockfd, (struct sockaddr*) &address, sizeof(address)) != 0)
+            return 0;
 
-        ffStrbufSubstrBefore(&procPath, procPathLength);
+        struct ucred ucred;
+        socklen_t len = sizeof(ucred);
+        if(getsockopt(sockfd, SOL_SOCKET, SO_PEERCRED, &ucred, &len) != 0)
+            return 0;
 
-        if(result->dePrettyName.length == 0)
-            applyPrettyNameIfDE(instance, result, processName.chars);
+        return (uint32_t) ucred.pid;
+    #else
+        return 0;
+    #endif
+}
 
-        if(result->wmPrettyName.length == 0)
-            applyPrettyNameIfWM(result, processName.chars);
+static void getFromProcDir(const FFinstance* instance, FFDisplayServerResult* result)
+{
+    uint32_t userID = (uint32_t) getuid();
 
-        if(result->dePrettyName.length > 0 && result->wmPrettyName.length > 0)
-            break;
-    }
+    //Fast path: only check the processes of the login session, instead of every process of the system
+    FF_LIST_AUTO_DESTROY sessionPids;
+    ffListInit(&sessionPids, sizeof(uint32_t));
+    getSessionPids(&sessionPids);
 
-    closedir(proc);
+    //The user slice contains every process of the user, so a WM / DE which isn't found there isn't running
+    if(sessionPids.length > 0)
+    {
+        FF_LIST_FOR_EACH(uint32_t, pid, sessionPids)
+        {
+            const FFProcessEntry* entry = ffProcTableGet(*pid);
+            if(entry != NULL && checkProcess(instance, result, entry, userID))
+                return;
+        }
+        return;
+    }
 
-    ffStrbufDestroy(&processName);
-    ffStrbufDestroy(&loginuid);
-    ffStrbufDestroy(&userID);
-    ffStrbufDestroy(&procPath);
+    FF_LIST_FOR_EACH(const FFProcessEntry*, entry, *ffProcTableGetAll())
+    {
+        if(checkProcess(instance, result, *entry, userID))
+            return;
+    }
 }
 
 void ffdsDetectWMDE(const FFinstance* instance, FFDisplayServerResult* result)
@@ -417,6 +524,18 @@ void ffdsDetectWMDE(const FFinstance* instance, FFDisplayServerResult* result)
 
     const char* env = parseEnv();
 
+    //The display server connections may have failed (or are not compiled in), but the compositor socket tells us the WM process directly
+    if(result->wmProcessName.length == 0)
+    {
+        uint32_t compositorPid = getWaylandCompositorPid();
+        const FFProcessEntry* compositor = compositorPid > 0 ? ffProcTableGet(compositorPid) : NULL;
+        if(compositor != NULL)
+        {
+            ffStrbufSet(&result->wmProcessName, ffProcTableGetArgv0(compositor));
+            ffStrbufSubstrAfterLastC(&result->wmProcessName, '/');
+        }
+    }
+
     if(result->wmProcessName.length > 0)
     {
         //If we found the processName via display server, use it.
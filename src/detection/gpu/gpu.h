@@ -8,6 +8,7 @@
 #define FF_GPU_TEMP_UNSET (0/0.0)
 #define FF_GPU_CORE_COUNT_UNSET -1
 #define FF_GPU_VMEM_SIZE_UNSET ((uint64_t)-1)
+#define FF_GPU_UTILIZATION_UNSET (0/0.0)
 
 extern const char* FF_GPU_VENDOR_NAME_APPLE;
 extern const char* FF_GPU_VENDOR_NAME_AMD;
@@ -38,6 +39,9 @@ typedef struct FFGPUResult
     int coreCount;
     FFGPUMemory dedicated;
     FFGPUMemory shared;
+    double utilization; // Percent
+    double frequencyCurrent; // GHz, 0 if unknown
+    double frequencyMax; // GHz, 0 if unknown
 } FFGPUResult;
 
 const FFlist* ffDetectGPU(const FFinstance* instance);
@@ -63,6 +63,8 @@ const char* ffDetectGPUImpl(FFlist* gpus, const FFinstance* instance)
         gpu->id = 0;
         gpu->dedicated.total = gpu->dedicated.used = gpu->shared.total = gpu->shared.used = FF_GPU_VMEM_SIZE_UNSET;
         gpu->type = FF_GPU_TYPE_UNKNOWN;
+        gpu->utilization = FF_GPU_UTILIZATION_UNSET;
+        gpu->frequencyCurrent = gpu->frequencyMax = 0;
 
         ffStrbufInit(&gpu->vendor);
         int vendorId;
@@ -1,14 +1,350 @@
 #include "detection/gpu/gpu.h"
 #include "detection/vulkan/vulkan.h"
+#include "common/io/io.h"
+#include "common/pciids.h"
+#include "common/properties.h"
+#include "detection/temps/temps_linux.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#define FF_PCI_SYSFS_DIR "/sys/bus/pci/devices/"
+
+static void normalizeVendorName(FFstrbuf* vendor)
+{
+    if(ffStrbufFirstIndexS(vendor, "AMD") < vendor->length || ffStrbufFirstIndexS(vendor, "ATI") < vendor->length)
+        ffStrbufSetS(vendor, FF_GPU_VENDOR_NAME_AMD);
+    else if(ffStrbufFirstIndexS(vendor, "Intel") < vendor->length)
+        ffStrbufSetS(vendor, FF_GPU_VENDOR_NAME_INTEL);
+    else if(ffStrbufFirstIndexS(vendor, "NVIDIA") < vendor->length)
+        ffStrbufSetS(vendor, FF_GPU_VENDOR_NAME_NVIDIA);
+}
+
+static void drmDetectAmdgpuName(const FFinstance* instance, FFGPUResult* gpu, uint16_t deviceId, uint8_t revId)
+{
+    //Lines look like "1309,\t00,\tAMD Radeon R7 Graphics"
+    char query[16];
+    snprintf(query, sizeof(query), "%04X,%02X,", deviceId, revId);
+
+    ffParsePropFileDataIndexed(instance, "libdrm/amdgpu.ids", ',', 2, query, &gpu->name);
+
+    const char* removeStrings[] = {
+        "AMD ", "ATI ",
+        " (TM)", "(TM)",
+        " Graphics Adapter", " Graphics", " Series", " Edition"
+    };
+    ffStrbufRemoveStringsA(&gpu->name, sizeof(removeStrings) / sizeof(removeStrings[0]), removeStrings);
+}
+
+static void extractMarketingName(FFstrbuf* name)
+{
+    //pci.ids names often look like "Navi 21 [Radeon RX 6800/6800 XT / 6900 XT]"
+    uint32_t openingBracket = ffStrbufFirstIndexC(name, '[');
+    uint32_t closingBracket = ffStrbufNextIndexC(name, openingBracket, ']');
+    if(closingBracket < name->length)
+    {
+        ffStrbufSubstrBefore(name, closingBracket);
+        ffStrbufSubstrAfter(name, openingBracket);
+    }
+}
+
+static void detectTemperature(const FFinstance* instance, FFGPUResult* gpu, uint16_t deviceClass)
+{
+    FFTempsResult* tempsResult = ffDetectTemps(instance);
+
+    FF_LIST_FOR_EACH(FFTempValue, tempValue, tempsResult->values)
+    {
+        //The kernel exposes the device class multiplied by 256 for some reason
+        if(tempValue->type == FF_SENSOR_TYPE_TEMP && tempValue->deviceClass == deviceClass * 256u && ffTempsUpdateValue(tempValue))
+        {
+            gpu->temperature = tempValue->value;
+            return;
+        }
+    }
+}
+
+static void detectTypeFromSizes(FFGPUResult* gpu, uint64_t romSize, uint32_t numSizes, const uint64_t* sizes)
+{
+    //There is no straightforward way to detect the type of a GPU.
+    //The approach taken here is to look at the memory sizes of the device.
+    //Since integrated GPUs usually use the system ram, they don't have expansive ROMs
+    //and their memory sizes are usually smaller than 1GB.
+
+    if(romSize > 0)
+    {
+        gpu->type = FF_GPU_TYPE_DISCRETE;
+        return;
+    }
+
+    for(uint32_t i = 0; i < numSizes; i++)
+    {
+        if(sizes[i] >= 1024 * 1024 * 1024) //1GB
+        {
+            gpu->type = FF_GPU_TYPE_DISCRETE;
+            return;
+        }
+    }
+
+    gpu->type = FF_GPU_TYPE_INTEGRATED;
+}
+
+static void initGPUResult(FFGPUResult* gpu)
+{
+    gpu->id = 0;
+    gpu->type = FF_GPU_TYPE_UNKNOWN;
+    gpu->dedicated.total = gpu->dedicated.used = gpu->shared.total = gpu->shared.used = FF_GPU_VMEM_SIZE_UNSET;
+    ffStrbufInit(&gpu->vendor);
+    ffStrbufInit(&gpu->name);
+    ffStrbufInit(&gpu->driver);
+    gpu->coreCount = FF_GPU_CORE_COUNT_UNSET;
+    gpu->temperature = FF_GPU_TEMP_UNSET;
+    gpu->utilization = FF_GPU_UTILIZATION_UNSET;
+    gpu->frequencyCurrent = gpu->frequencyMax = 0;
+}
+
+// Reads a small sysfs file relative to the device directory fd
+static uint32_t sysfsReadAt(int dfd, const char* path, char* buffer, uint32_t bufferSize)
+{
+    int FF_AUTO_CLOSE_FD fd = openat(dfd, path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return 0;
+
+    ssize_t length = read(fd, buffer, bufferSize - 1);
+    if(length <= 0)
+        return 0;
+    buffer[length] = '\0';
+    return (uint32_t) length;
+}
+
+static bool sysfsReadUInt64(int dfd, const char* path, int base, uint64_t* result)
+{
+    char buffer[32];
+    if(sysfsReadAt(dfd, path, buffer, sizeof(buffer)) == 0)
+        return false;
+
+    char* end;
+    *result = strtoull(buffer, &end, base);
+    return end != buffer;
+}
+
+static bool sysfsReadHex(int dfd, const char* path, uint32_t* result)
+{
+    uint64_t value;
+    if(!sysfsReadUInt64(dfd, path, 16, &value))
+        return false;
+    *result = (uint32_t) value;
+    return true;
+}
+
+static void sysfsDetectType(int dfd, FFGPUResult* gpu)
+{
+    int FF_AUTO_CLOSE_FD fd = openat(dfd, "resource", O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return;
+
+    FF_STRBUF_AUTO_DESTROY content;
+    ffStrbufInitA(&content, 1024);
+    if(!ffAppendFDBuffer(fd, &content))
+        return;
+
+    //One "start end flags" line per resource. The first 6 are the BARs, the 7th is the expansion ROM
+    uint64_t sizes[6] = {0};
+    uint64_t romSize = 0;
+    const char* line = content.chars;
+    for(uint32_t i = 0; i < 7 && *line != '\0'; i++)
+    {
+        char* end;
+        uint64_t start = strtoull(line, &end, 16);
+        uint64_t last = strtoull(end, &end, 16);
+        uint64_t size = last > start ? last - start + 1 : 0;
+        if(i < 6)
+            sizes[i] = size;
+        else
+            romSize = size;
+
+        line = strchr(end, '\n');
+        if(line == NULL)
+            break;
+        ++line;
+    }
+
+    detectTypeFromSizes(gpu, romSize, 6, sizes);
+}
+
+static void sysfsDetectDriver(int dfd, FFGPUResult* gpu)
+{
+    ffStrbufEnsureFree(&gpu->driver, 1023);
+    ssize_t resultLength = readlinkat(dfd, "driver", gpu->driver.chars, gpu->driver.allocated - 1); //-1 for null terminator
+    if(resultLength > 0)
+    {
+        gpu->driver.length = (uint32_t) resultLength;
+        gpu->driver.chars[resultLength] = '\0';
+        ffStrbufSubstrAfterLastC(&gpu->driver, '/');
+    }
+}
+
+static void sysfsDetectAmdgpuClocks(int dfd, FFGPUResult* gpu)
+{
+    //One line per DPM state, the active one is marked: "0: 500Mhz\n1: 2100Mhz *\n"
+    char buffer[512];
+    if(sysfsReadAt(dfd, "pp_dpm_sclk", buffer, sizeof(buffer)) == 0)
+        return;
+
+    for(const char* line = buffer; *line != '\0';)
+    {
+        const char* colon = strchr(line, ':');
+        if(colon == NULL)
+            break;
+
+        char* end;
+        double mhz = strtod(colon + 1, &end);
+        if(end != colon + 1)
+        {
+            double ghz = mhz / 1000.0;
+            if(ghz > gpu->frequencyMax)
+                gpu->frequencyMax = ghz;
+
+            const char* lineEnd = strchr(end, '\n');
+            const char* star = strchr(end, '*');
+            if(star != NULL && (lineEnd == NULL || star < lineEnd))
+                gpu->frequencyCurrent = ghz;
+        }
+
+        line = strchr(colon, '\n');
+        if(line == NULL)
+            break;
+        ++line;
+    }
+}
+
+static void sysfsDetectIntelClocks(int dfd, FFGPUResult* gpu)
+{
+    uint64_t mhz;
+
+    if(ffStrbufCompS(&gpu->driver, "xe") == 0)
+    {
+        if(sysfsReadUInt64(dfd, "tile0/gt0/freq0/act_freq", 10, &mhz))
+            gpu->frequencyCurrent = (double) mhz / 1000.0;
+        if(sysfsReadUInt64(dfd, "tile0/gt0/freq0/rp0_freq", 10, &mhz))
+            gpu->frequencyMax = (double) mhz / 1000.0;
+        return;
+    }
+
+    //i915 exposes its clocks at the DRM card, which is a sub directory of the PCI device: drm/cardN
+    int drmfd = openat(dfd, "drm", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(drmfd < 0)
+        return;
+
+    DIR* dirp = fdopendir(drmfd);
+    if(dirp == NULL)
+    {
+        close(drmfd);
+        return;
+    }
+
+    struct dirent* entry;
+    while((entry = readdir(dirp)) != NULL)
+    {
+        if(strncmp(entry->d_name, "card", 4) != 0)
+            continue;
+
+        int FF_AUTO_CLOSE_FD cardfd = openat(drmfd, entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(cardfd < 0)
+            continue;
+
+        if(sysfsReadUInt64(cardfd, "gt_act_freq_mhz", 10, &mhz) || sysfsReadUInt64(cardfd, "gt_cur_freq_mhz", 10, &mhz))
+            gpu->frequencyCurrent = (double) mhz / 1000.0;
+        if(sysfsReadUInt64(cardfd, "gt_RP0_freq_mhz", 10, &mhz) || sysfsReadUInt64(cardfd, "gt_max_freq_mhz", 10, &mhz))
+            gpu->frequencyMax = (double) mhz / 1000.0;
+        break;
+    }
+
+    closedir(dirp);
+}
+
+static void sysfsDetectMetrics(int dfd, FFGPUResult* gpu)
+{
+    if(ffStrbufCompS(&gpu->driver, "amdgpu") == 0)
+    {
+        uint64_t value;
+        if(sysfsReadUInt64(dfd, "mem_info_vram_total", 10, &value))
+        {
+            gpu->dedicated.total = value;
+            if(sysfsReadUInt64(dfd, "mem_info_vram_used", 10, &value))
+                gpu->dedicated.used = value;
+        }
+
+        if(sysfsReadUInt64(dfd, "gpu_busy_percent", 10, &value))
+            gpu->utilization = (double) value;
+
+        sysfsDetectAmdgpuClocks(dfd, gpu);
+    }
+    else if(ffStrbufCompS(&gpu->driver, "i915") == 0 || ffStrbufCompS(&gpu->driver, "xe") == 0)
+        sysfsDetectIntelClocks(dfd, gpu);
+}
+
+static void sysfsHandleDevice(const FFinstance* instance, FFlist* results, int dfd)
+{
+    uint32_t pciClass, vendorId, deviceId, revId = 0;
+    if(
+        !sysfsReadHex(dfd, "class", &pciClass) ||
+        //https://pci-ids.ucw.cz/read/PD/03
+        (pciClass >> 16) != 0x03 ||
+        !sysfsReadHex(dfd, "vendor", &vendorId) ||
+        !sysfsReadHex(dfd, "device", &deviceId)
+    ) return;
+
+    sysfsReadHex(dfd, "revision", &revId);
+
+    FFGPUResult* gpu = ffListAdd(results);
+    initGPUResult(gpu);
+
+    ffStrbufAppendS(&gpu->vendor, ffGetGPUVendorString(vendorId));
+    if(gpu->vendor.length == 0 && ffPciIdsLookupVendor(instance, (uint16_t) vendorId, &gpu->vendor))
+        normalizeVendorName(&gpu->vendor);
+
+    if(ffStrbufCompS(&gpu->vendor, FF_GPU_VENDOR_NAME_AMD) == 0)
+        drmDetectAmdgpuName(instance, gpu, (uint16_t) deviceId, (uint8_t) revId);
+
+    if(gpu->name.length == 0 && ffPciIdsLookupDevice(instance, (uint16_t) vendorId, (uint16_t) deviceId, &gpu->name))
+        extractMarketingName(&gpu->name);
+
+    sysfsDetectDriver(dfd, gpu);
+    sysfsDetectType(dfd, gpu);
+    sysfsDetectMetrics(dfd, gpu);
+
+    if(instance->config.gpuTemp)
+        detectTemperature(instance, gpu, (uint16_t) (pciClass >> 8));
+}
+
+static const char* sysfsDetectGPUs(const FFinstance* instance, FFlist* gpus)
+{
+    DIR* dirp = opendir(FF_PCI_SYSFS_DIR);
+    if(dirp == NULL)
+        return "opendir(\"" FF_PCI_SYSFS_DIR "\") == NULL";
+
+    struct dirent* entry;
+    while((entry = readdir(dirp)) != NULL)
+    {
+        if(entry->d_name[0] == '.')
+            continue;
+
+        int FF_AUTO_CLOSE_FD dfd = openat(dirfd(dirp), entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(dfd >= 0)
+            sysfsHandleDevice(instance, gpus, dfd);
+    }
+
+    closedir(dirp);
+    return NULL;
+}
 
 #ifdef FF_HAVE_LIBPCI
 #include "common/library.h"
-#include "common/properties.h"
 #include "common/parsing.h"
-#include "detection/temps/temps_linux.h"
 #include "util/stringUtils.h"
-#include <string.h>
-#include <unistd.h>
 #include <pci/pci.h>
 
 typedef struct PCIData
@@ -35,12 +371,7 @@ static void pciDetectVendorName(FFGPUResult* gpu, PCIData* pci, struct pci_dev*
     pci->ffpci_lookup_name(pci->access, gpu->vendor.chars, (int) gpu->vendor.allocated, PCI_LOOKUP_VENDOR, device->vendor_id);
     ffStrbufRecalculateLength(&gpu->vendor);
 
-    if(ffStrbufFirstIndexS(&gpu->vendor, "AMD") < gpu->vendor.length || ffStrbufFirstIndexS(&gpu->vendor, "ATI") < gpu->vendor.length)
-        ffStrbufSetS(&gpu->vendor, FF_GPU_VENDOR_NAME_AMD);
-    else if(ffStrbufFirstIndexS(&gpu->vendor, "Intel") < gpu->vendor.length)
-        ffStrbufSetS(&gpu->vendor, FF_GPU_VENDOR_NAME_INTEL);
-    else if(ffStrbufFirstIndexS(&gpu->vendor, "NVIDIA") < gpu->vendor.length)
-        ffStrbufSetS(&gpu->vendor, FF_GPU_VENDOR_NAME_NVIDIA);
+    normalizeVendorName(&gpu->vendor);
 }
 
 static void drmDetectDeviceName(const FFinstance* instance, FFGPUResult* gpu, PCIData* pci, struct pci_dev* device)
@@ -63,20 +394,7 @@ static void drmDetectDeviceName(const FFinstance* instance, FFGPUResult* gpu, PC
         #endif
     }
 
-    FFstrbuf query;
-    ffStrbufInit(&query);
-    ffStrbufAppendF(&query, "%X, %X,", device->device_id, revId);
-
-    ffParsePropFileData(instance, "libdrm/amdgpu.ids", query.chars, &gpu->name);
-
-    ffStrbufDestroy(&query);
-
-    const char* removeStrings[] = {
-        "AMD ", "ATI ",
-        " (TM)", "(TM)",
-        " Graphics Adapter", " Graphics", " Series", " Edition"
-    };
-    ffStrbufRemoveStringsA(&gpu->name, sizeof(removeStrings) / sizeof(removeStrings[0]), removeStrings);
+    drmDetectAmdgpuName(instance, gpu, device->device_id, revId);
 }
 
 static void pciDetectDeviceName(const FFinstance* instance, FFGPUResult* gpu, PCIData* pci, struct pci_dev* device)
@@ -92,13 +410,7 @@ static void pciDetectDeviceName(const FFinstance* instance, FFGPUResult* gpu, PC
     pci->ffpci_lookup_name(pci->access, gpu->name.chars, (int) gpu->name.allocated, PCI_LOOKUP_DEVICE, device->vendor_id, device->device_id);
     ffStrbufRecalculateLength(&gpu->name);
 
-    uint32_t openingBracket = ffStrbufFirstIndexC(&gpu->name, '[');
-    uint32_t closingBracket = ffStrbufNextIndexC(&gpu->name, openingBracket, ']');
-    if(closingBracket < gpu->name.length)
-    {
-        ffStrbufSubstrBefore(&gpu->name, closingBracket);
-        ffStrbufSubstrAfter(&gpu->name, openingBracket);
-    }
+    extractMarketingName(&gpu->name);
 }
 
 static void pciDetectDriverName(FFGPUResult* gpu, PCIData* pci, struct pci_dev* device)
@@ -131,53 +443,19 @@ static void pciDetectDriverName(FFGPUResult* gpu, PCIData* pci, struct pci_dev*
     ffStrbufDestroy(&path);
 }
 
-static void pciDetectTemperatur(FFGPUResult* gpu, struct pci_dev* device)
+static void pciDetectType(FFGPUResult* gpu, const PCIData* pci, struct pci_dev* device)
 {
-    const FFTempsResult* tempsResult = ffDetectTemps();
-
-    for(uint32_t i = 0; i < tempsResult->values.length; i++)
-    {
-        FFTempValue* tempValue = ffListGet(&tempsResult->values, i);
-
-        //The kernel exposes the device class multiplied by 256 for some reason
-        if(tempValue->deviceClass == device->device_class * 256)
-        {
-            gpu->temperature = tempValue->value;
-            return;
-        }
-    }
-}
-
-static void detectType(FFGPUResult* gpu, const PCIData* pci, struct pci_dev* device)
-{
-    //There is no straightforward way to detect the type of a GPU.
-    //The approach taken here is to look at the memory sizes of the device.
-    //Since integrated GPUs usually use the system ram, they don't have expansive ROMs
-    //and their memory sizes are usually smaller than 1GB.
-
     if(!(pci->ffpci_fill_info(device, PCI_FILL_SIZES) & PCI_FILL_SIZES))
     {
         gpu->type = FF_GPU_TYPE_UNKNOWN;
         return;
     }
 
-    if(device->rom_size > 0)
-    {
-        gpu->type = FF_GPU_TYPE_DISCRETE;
-        return;
-    }
-
-    uint32_t numSizes = sizeof(device->size) / sizeof(device->size[0]);
-    for(uint32_t i = 0; i < numSizes; i++)
-    {
-        if(device->size[i] >= 1024 * 1024 * 1024) //1GB
-        {
-            gpu->type = FF_GPU_TYPE_DISCRETE;
-            return;
-        }
-    }
+    uint64_t sizes[sizeof(device->size) / sizeof(device->size[0])];
+    for(uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        sizes[i] = device->size[i];
 
-    gpu->type = FF_GPU_TYPE_INTEGRATED;
+    detectTypeFromSizes(gpu, device->rom_size, sizeof(sizes) / sizeof(sizes[0]), sizes);
 }
 
 static void pciHandleDevice(const FFinstance* instance, FFlist* results, PCIData* pci, struct pci_dev* device)
@@ -198,26 +476,15 @@ static void pciHandleDevice(const FFinstance* instance, FFlist* results, PCIData
     pci->ffpci_fill_info(device, PCI_FILL_IDENT);
 
     FFGPUResult* gpu = ffListAdd(results);
+    initGPUResult(gpu);
 
-    gpu->id = 0;
-        gpu->dedicated.total = gpu->dedicated.used = gpu->shared.total = gpu->shared.used = FF_GPU_VMEM_SIZE_UNSET;
-
-    ffStrbufInit(&gpu->vendor);
     pciDetectVendorName(gpu, pci, device);
-
-    ffStrbufInit(&gpu->name);
     pciDetectDeviceName(instance, gpu, pci, device);
-
-    ffStrbufInit(&gpu->driver);
     pciDetectDriverName(gpu, pci, device);
+    pciDetectType(gpu, pci, device);
 
-    detectType(gpu, pci, device);
-
-    gpu->coreCount = FF_GPU_CORE_COUNT_UNSET;
-
-    gpu->temperature = FF_GPU_TEMP_UNSET;
     if(instance->config.gpuTemp)
-        pciDetectTemperatur(gpu, device);
+        detectTemperature(instance, gpu, device->device_class);
 }
 
 static const char* pciDetectGPUs(const FFinstance* instance, FFlist* gpus)
@@ -258,10 +525,14 @@ static const char* pciDetectGPUs(const FFinstance* instance, FFlist* gpus)
 
 const char* ffDetectGPUImpl(FFlist* gpus, const FFinstance* instance)
 {
+    //sysfs is enough on Linux. libpci is used where it isn't available, e.g. on BSD
+    const char* error = sysfsDetectGPUs(instance, gpus);
+    if(error == NULL)
+        return NULL;
+
     #ifdef FF_HAVE_LIBPCI
         return pciDetectGPUs(instance, gpus);
     #else
-        FF_UNUSED(gpus, instance);
-        return "fastfetch is built without libpci support";
+        return error;
     #endif
 }
@@ -47,6 +47,8 @@ static const char* detectWithRegistry(FFlist* gpus)
         ffStrbufInit(&gpu->driver);
         gpu->temperature = FF_GPU_TEMP_UNSET;
         gpu->coreCount = FF_GPU_CORE_COUNT_UNSET;
+        gpu->utilization = FF_GPU_UTILIZATION_UNSET;
+        gpu->frequencyCurrent = gpu->frequencyMax = 0;
         gpu->type = FF_GPU_TYPE_UNKNOWN;
         gpu->id = 0;
         gpu->dedicated.total = gpu->dedicated.used = gpu->shared.total = gpu->shared.used = FF_GPU_VMEM_SIZE_UNSET;
@@ -122,6 +124,8 @@ static const char* detectWithDxgi(FFlist* gpus)
 
         gpu->temperature = FF_GPU_TEMP_UNSET;
         gpu->coreCount = FF_GPU_CORE_COUNT_UNSET;
+        gpu->utilization = FF_GPU_UTILIZATION_UNSET;
+        gpu->frequencyCurrent = gpu->frequencyMax = 0;
     }
 
     pFactory->Release();
@@ -1,101 +1,366 @@
 #include "fastfetch.h"
+#include "common/caching.h"
 #include "common/io/io.h"
 #include "common/thread.h"
 #include "temps_linux.h"
 
 #include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <fcntl.h>
 #include <dirent.h>
+#include <unistd.h>
 
-static bool parseHwmonDir(FFstrbuf* dir, FFTempValue* value)
+//https://www.kernel.org/doc/Documentation/hwmon/sysfs-interface
+#define FF_HWMON_DIR "/sys/class/hwmon/"
+
+static const char* sensorTypePrefixes[] = {
+    [FF_SENSOR_TYPE_TEMP] = "temp",
+    [FF_SENSOR_TYPE_FAN] = "fan",
+    [FF_SENSOR_TYPE_POWER] = "power",
+};
+
+// The static part of a sensor. Persisted in the detection cache while the boot and the hwmon devices stay the same
+typedef struct CachedSensor
 {
-    //https://www.kernel.org/doc/Documentation/hwmon/sysfs-interface
-    uint32_t dirLength = dir->length;
+    uint32_t hwmon; // N of hwmonN
+    uint32_t channel;
+    uint32_t deviceClass;
+    uint8_t type;
+    uint8_t role;
+    char name[32];
+    char label[32];
+} CachedSensor;
 
-    FF_STRBUF_AUTO_DESTROY valueBuffer;
-    ffStrbufInit(&valueBuffer);
+// Reads a small sysfs file into a zero terminated buffer, without the trailing new line
+static uint32_t readSmallFileAt(int dfd, const char* path, char* buffer, uint32_t bufferSize)
+{
+    int FF_AUTO_CLOSE_FD fd = openat(dfd, path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return 0;
 
-    ffStrbufAppendS(dir, "temp1_input");
-    if(!ffReadFileBuffer(dir->chars, &valueBuffer))
-        return false;
+    ssize_t length = read(fd, buffer, bufferSize - 1);
+    if(length <= 0)
+        return 0;
 
-    ffStrbufSubstrBefore(dir, dirLength);
+    while(length > 0 && (buffer[length - 1] == '\n' || buffer[length - 1] == ' '))
+        --length;
+    buffer[length] = '\0';
+    return (uint32_t) length;
+}
 
-    value->value = ffStrbufToDouble(&valueBuffer) / 1000; // valueBuffer is millidegree Celsius
+static FFSensorRole detectRole(const char* name, uint32_t deviceClass)
+{
+    //The kernel exposes the PCI class code including the programming interface, 0x03XXXX is a display controller
+    if((deviceClass >> 16) == 0x03)
+        return FF_SENSOR_ROLE_GPU;
 
-    if(value->value != value->value)
-        return false;
+    if(
+        strstr(name, "cpu") != NULL ||
+        strcmp(name, "k10temp") == 0 ||
+        strcmp(name, "coretemp") == 0 ||
+        strcmp(name, "zenpower") == 0
+    ) return FF_SENSOR_ROLE_CPU;
 
-    ffStrbufAppendS(dir, "name");
-    ffReadFileBuffer(dir->chars, &value->name);
-    ffStrbufSubstrBefore(dir, dirLength);
+    if(
+        strcmp(name, "amdgpu") == 0 ||
+        strcmp(name, "radeon") == 0 ||
+        strcmp(name, "nouveau") == 0 ||
+        strcmp(name, "i915") == 0
+    ) return FF_SENSOR_ROLE_GPU;
 
-    ffStrbufAppendS(dir, "device/class");
-    if(!ffReadFileBuffer(dir->chars, &valueBuffer))
-    {
-        ffStrbufSubstrBefore(dir, dirLength);
-        ffStrbufAppendS(dir, "device/device/class");
-        ffReadFileBuffer(dir->chars, &valueBuffer);
-    }
-    if(valueBuffer.length)
-        value->deviceClass = (uint32_t) strtoul(valueBuffer.chars, NULL, 16);
+    if(strncasecmp(name, "BAT", 3) == 0 || strstr(name, "battery") != NULL)
+        return FF_SENSOR_ROLE_BATTERY;
 
-    return value->name.length > 0 || value->deviceClass > 0;
+    return FF_SENSOR_ROLE_UNKNOWN;
 }
 
-const FFTempsResult* ffDetectTemps()
+static void enumerateChannels(int hwmonfd, const CachedSensor* device, FFlist* sensors)
 {
-    static FFTempsResult result;
-    static FFThreadMutex mutex = FF_THREAD_MUTEX_INITIALIZER;
-    static bool init = false;
+    int fd = openat(hwmonfd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(fd < 0)
+        return;
 
-    ffThreadMutexLock(&mutex);
-    if(init)
+    DIR* dirp = fdopendir(fd);
+    if(dirp == NULL)
     {
-        ffThreadMutexUnlock(&mutex);
-        return &result;
+        close(fd);
+        return;
     }
-    init = true;
 
-    ffListInitA(&result.values, sizeof(FFTempValue), 16);
+    struct dirent* entry;
+    while((entry = readdir(dirp)) != NULL)
+    {
+        for(uint8_t type = 0; type < sizeof(sensorTypePrefixes) / sizeof(sensorTypePrefixes[0]); type++)
+        {
+            size_t prefixLength = strlen(sensorTypePrefixes[type]);
+            if(strncmp(entry->d_name, sensorTypePrefixes[type], prefixLength) != 0)
+                continue;
 
-    FFstrbuf baseDir;
-    ffStrbufInitA(&baseDir, 64);
-    ffStrbufAppendS(&baseDir, "/sys/class/hwmon/");
+            char* end;
+            unsigned long channel = strtoul(entry->d_name + prefixLength, &end, 10);
+            if(end == entry->d_name + prefixLength || strcmp(end, "_input") != 0)
+                continue;
 
-    uint32_t baseDirLength = baseDir.length;
+            CachedSensor* sensor = ffListAdd(sensors);
+            *sensor = *device;
+            sensor->type = type;
+            sensor->channel = (uint32_t) channel;
 
-    DIR* dirp = opendir(baseDir.chars);
-    if(dirp == NULL)
-    {
-        ffStrbufDestroy(&baseDir);
-        ffThreadMutexUnlock(&mutex);
-        return &result;
+            char labelPath[64];
+            snprintf(labelPath, sizeof(labelPath), "%s%u_label", sensorTypePrefixes[type], sensor->channel);
+            readSmallFileAt(hwmonfd, labelPath, sensor->label, sizeof(sensor->label));
+            break;
+        }
     }
 
+    closedir(dirp);
+}
+
+static int compareSensors(const void* a, const void* b)
+{
+    const CachedSensor* x = a;
+    const CachedSensor* y = b;
+    if(x->hwmon != y->hwmon)
+        return x->hwmon < y->hwmon ? -1 : 1;
+    if(x->type != y->type)
+        return x->type < y->type ? -1 : 1;
+    if(x->channel != y->channel)
+        return x->channel < y->channel ? -1 : 1;
+    return 0;
+}
+
+static void enumerateSensors(FFlist* sensors)
+{
+    DIR* dirp = opendir(FF_HWMON_DIR);
+    if(dirp == NULL)
+        return;
+
     struct dirent* entry;
     while((entry = readdir(dirp)) != NULL)
     {
-        if(entry->d_name[0] == '.')
+        if(strncmp(entry->d_name, "hwmon", 5) != 0)
+            continue;
+
+        int FF_AUTO_CLOSE_FD hwmonfd = openat(dirfd(dirp), entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(hwmonfd < 0)
             continue;
 
-        ffStrbufAppendS(&baseDir, entry->d_name);
-        ffStrbufAppendC(&baseDir, '/');
+        CachedSensor device;
+        memset(&device, 0, sizeof(device));
+        device.hwmon = (uint32_t) strtoul(entry->d_name + 5, NULL, 10);
+        readSmallFileAt(hwmonfd, "name", device.name, sizeof(device.name));
+
+        char deviceClass[16];
+        if(
+            readSmallFileAt(hwmonfd, "device/class", deviceClass, sizeof(deviceClass)) ||
+            readSmallFileAt(hwmonfd, "device/device/class", deviceClass, sizeof(deviceClass))
+        ) device.deviceClass = (uint32_t) strtoul(deviceClass, NULL, 16);
+
+        device.role = (uint8_t) detectRole(device.name, device.deviceClass);
+
+        enumerateChannels(hwmonfd, &device, sensors);
+    }
+
+    closedir(dirp);
+
+    // readdir order is arbitrary. Sorted, the first channel of a role is the main one (e.g. Tctl, Package id 0)
+    qsort(sensors->data, sensors->length, sensors->elementSize, compareSensors);
+}
+
+// Opens one dirfd per hwmon device. Fails if the hwmon devices were renumbered since the sensors were cached.
+// On failure, the values added so far must be freed with destroyValues
+static bool openSensors(const FFlist* sensors, FFlist* values)
+{
+    int FF_AUTO_CLOSE_FD basefd = open(FF_HWMON_DIR, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(basefd < 0)
+        return false;
+
+    int hwmonfd = -1;
+    uint32_t hwmon = UINT32_MAX;
 
-        FFTempValue* temp = ffListAdd(&result.values);
-        ffStrbufInit(&temp->name);
-        temp->deviceClass = 0;
-        if(!parseHwmonDir(&baseDir, temp))
+    FF_LIST_FOR_EACH(CachedSensor, sensor, *sensors)
+    {
+        if(sensor->hwmon != hwmon)
         {
-            ffStrbufDestroy(&temp->name);
-            --result.values.length;
+            hwmon = sensor->hwmon;
+
+            char path[32];
+            snprintf(path, sizeof(path), "hwmon%u", hwmon);
+            hwmonfd = openat(basefd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+            if(hwmonfd < 0)
+                return false;
+
+            char name[sizeof(sensor->name)] = "";
+            readSmallFileAt(hwmonfd, "name", name, sizeof(name));
+            if(strcmp(name, sensor->name) != 0)
+            {
+                close(hwmonfd);
+                return false;
+            }
         }
 
-        ffStrbufSubstrBefore(&baseDir, baseDirLength);
+        FFTempValue* value = ffListAdd(values);
+        ffStrbufInitS(&value->name, sensor->name);
+        ffStrbufInitS(&value->label, sensor->label);
+        value->deviceClass = sensor->deviceClass;
+        value->type = (FFSensorType) sensor->type;
+        value->role = (FFSensorRole) sensor->role;
+        value->channel = sensor->channel;
+        value->dirfd = hwmonfd;
+        value->fd = -1;
+        value->value = 0.0/0.0;
+    }
+
+    return true;
+}
+
+static void destroyValues(FFlist* values)
+{
+    int dirfd = -1;
+    FF_LIST_FOR_EACH(FFTempValue, value, *values)
+    {
+        ffStrbufDestroy(&value->name);
+        ffStrbufDestroy(&value->label);
+        if(value->fd >= 0)
+            close(value->fd);
+        if(value->dirfd != dirfd)
+        {
+            dirfd = value->dirfd;
+            close(dirfd);
+        }
+    }
+    values->length = 0;
+}
+
+// The cached sensors are valid for one boot and one set of hwmon devices.
+// Drivers loaded late (e.g. nct6775, it87) add hwmonN entries after the cache was written
+typedef struct HwmonCacheKey
+{
+    char bootId[FF_CACHE_BOOT_ID_LENGTH];
+    uint32_t count;
+    uint32_t hash; // Sum of the FNV-1a hashes of the entry names, so that readdir order doesn't matter
+} HwmonCacheKey;
+
+static bool getCacheKey(HwmonCacheKey* key)
+{
+    memset(key, 0, sizeof(*key));
+
+    if(!ffCacheGetBootId(key->bootId))
+        return false;
+
+    DIR* dirp = opendir(FF_HWMON_DIR);
+    if(dirp == NULL)
+        return false;
+
+    struct dirent* entry;
+    while((entry = readdir(dirp)) != NULL)
+    {
+        if(strncmp(entry->d_name, "hwmon", 5) != 0)
+            continue;
+
+        uint32_t hash = 2166136261u; //FNV-1a
+        for(const char* p = entry->d_name; *p; ++p)
+            hash = (hash ^ (uint8_t) *p) * 16777619u;
+
+        key->hash += hash;
+        ++key->count;
     }
 
     closedir(dirp);
-    ffStrbufDestroy(&baseDir);
+    return true;
+}
+
+static void detectTemps(const FFinstance* instance, FFTempsResult* result)
+{
+    ffListInitA(&result->values, sizeof(FFTempValue), 16);
+
+    HwmonCacheKey key;
+    bool hasKey = getCacheKey(&key);
+
+    FF_LIST_AUTO_DESTROY sensors;
+    ffListInit(&sensors, sizeof(CachedSensor));
+
+    FF_STRBUF_AUTO_DESTROY content;
+    ffStrbufInit(&content);
+    if(hasKey && ffCacheReadStrbuf(instance, "hwmon", sizeof(key), &key, &content) && content.length % sizeof(CachedSensor) == 0)
+    {
+        for(uint32_t i = 0; i < content.length; i += (uint32_t) sizeof(CachedSensor))
+            memcpy(ffListAdd(&sensors), content.chars + i, sizeof(CachedSensor));
+
+        if(openSensors(&sensors, &result->values))
+            return;
+
+        destroyValues(&result->values);
+        sensors.length = 0;
+    }
+
+    enumerateSensors(&sensors);
+    if(!openSensors(&sensors, &result->values))
+        return;
+
+    if(hasKey)
+        ffCacheWrite(instance, "hwmon", sizeof(key), &key, sensors.length * sensors.elementSize, sensors.data);
+}
 
+FFTempsResult* ffDetectTemps(const FFinstance* instance)
+{
+    static FFTempsResult result;
+    static FFThreadMutex mutex = FF_THREAD_MUTEX_INITIALIZER;
+    static bool init = false;
+
+    ffThreadMutexLock(&mutex);
+    if(!init)
+    {
+        init = true;
+        detectTemps(instance, &result);
+    }
     ffThreadMutexUnlock(&mutex);
+
     return &result;
 }
+
+bool ffTempsUpdateValue(FFTempValue* value)
+{
+    if(value->fd < 0)
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "%s%u_input", sensorTypePrefixes[value->type], value->channel);
+        value->fd = openat(value->dirfd, path, O_RDONLY | O_CLOEXEC);
+        if(value->fd < 0)
+            return false;
+    }
+
+    char buffer[32];
+    ssize_t length = pread(value->fd, buffer, sizeof(buffer) - 1, 0);
+    if(length <= 0)
+        return false;
+    buffer[length] = '\0';
+
+    char* end;
+    long raw = strtol(buffer, &end, 10);
+    if(end == buffer)
+        return false;
+
+    switch(value->type)
+    {
+        case FF_SENSOR_TYPE_TEMP: value->value = (double) raw / 1000.0; break; // millidegree Celsius
+        case FF_SENSOR_TYPE_POWER: value->value = (double) raw / 1000.0 / 1000.0; break; // microwatt
+        default: value->value = (double) raw; break;
+    }
+    return true;
+}
+
+const FFTempValue* ffTempsFindRole(const FFinstance* instance, FFSensorRole role, FFSensorType type)
+{
+    FFTempsResult* temps = ffDetectTemps(instance);
+
+    FF_LIST_FOR_EACH(FFTempValue, value, temps->values)
+    {
+        if(value->role == role && value->type == type && ffTempsUpdateValue(value))
+            return value;
+    }
+
+    return NULL;
+}
@@ -5,18 +5,46 @@
 
 #include "fastfetch.h"
 
+typedef enum FFSensorType
+{
+    FF_SENSOR_TYPE_TEMP, // °C
+    FF_SENSOR_TYPE_FAN, // RPM
+    FF_SENSOR_TYPE_POWER, // W
+} FFSensorType;
+
+typedef enum FFSensorRole
+{
+    FF_SENSOR_ROLE_UNKNOWN,
+    FF_SENSOR_ROLE_CPU,
+    FF_SENSOR_ROLE_GPU,
+    FF_SENSOR_ROLE_BATTERY,
+} FFSensorRole;
+
 typedef struct FFTempValue
 {
-    FFstrbuf name;
+    FFstrbuf name; // hwmon name, e.g. "k10temp"
+    FFstrbuf label; // channel label, e.g. "Tctl". May be empty
     uint32_t deviceClass;
-    double value;
+    FFSensorType type;
+    FFSensorRole role;
+    uint32_t channel;
+    int dirfd; // hwmonN, shared by all channels of the device
+    int fd; // <type><N>_input, opened on first update and kept open
+    double value; // NaN until ffTempsUpdateValue is called
 } FFTempValue;
 
 typedef struct FFTempsResult
 {
-    FFlist values; //List of FFTempValue
+    FFlist values; //List of FFTempValue, all channels of all hwmon devices
 } FFTempsResult;
 
-const FFTempsResult* ffDetectTemps();
+// Enumerated once. Not const, because values are updated in place
+FFTempsResult* ffDetectTemps(const FFinstance* instance);
+
+// Re-reads the current value of a sensor with a single pread
+bool ffTempsUpdateValue(FFTempValue* value);
+
+// First sensor with the given role and type, or NULL
+const FFTempValue* ffTempsFindRole(const FFinstance* instance, FFSensorRole role, FFSensorType type);
 
 #endif
@@ -10,7 +10,9 @@
 #include <stdlib.h>
 #include <unistd.h>
 
-#ifdef __APPLE__
+#ifdef __linux__
+    #include "common/proctable.h"
+#elif defined(__APPLE__)
     #include <libproc.h>
 #elif defined(__FreeBSD__)
     #include <sys/types.h>
@@ -33,12 +35,10 @@ static void getProcessInformation(pid_t pid, FFstrbuf* processName, FFstrbuf* ex
 
     #ifdef __linux__
 
-    char cmdlineFilePath[64];
-    snprintf(cmdlineFilePath, sizeof(cmdlineFilePath), "/proc/%d/cmdline", (int)pid);
-
-    if(ffAppendFileBuffer(cmdlineFilePath, exe))
+    const FFProcessEntry* entry = ffProcTableGet((uint32_t) pid);
+    if(entry != NULL)
     {
-        ffStrbufSubstrBeforeFirstC(exe, '\0'); //Trim the arguments
+        ffStrbufAppend(exe, ffProcTableGetArgv0(entry));
         ffStrbufTrimLeft(exe, '-'); //Happens in TTY
     }
 
@@ -72,21 +72,14 @@ static const char* getProcessNameAndPpid(pid_t pid, char* name, pid_t* ppid)
 
     #ifdef __linux__
 
-    char statFilePath[64];
-    snprintf(statFilePath, sizeof(statFilePath), "/proc/%d/stat", (int)pid);
-    FILE* stat = fopen(statFilePath, "r");
-    if(stat == NULL)
-        return "fopen(statFilePath, \"r\") failed";
-
-    *ppid = 0;
-    if(
-        fscanf(stat, "%*s (%255[^)]) %*c %d", name, ppid) != 2 || //stat (comm) state ppid
-        !ffStrSet(name) ||
-        *ppid == 0
-    )
-        error = "fscanf(stat) failed";
+    const FFProcessEntry* entry = ffProcTableGet((uint32_t) pid);
+    if(entry == NULL)
+        return "ffProcTableGet(pid) failed";
 
-    fclose(stat);
+    strcpy(name, entry->comm); //comm is shorter than 256 chars
+    *ppid = (pid_t) entry->ppid;
+    if(!ffStrSet(name) || *ppid == 0)
+        error = "Invalid stat of process";
 
     #elif defined(__APPLE__)
 
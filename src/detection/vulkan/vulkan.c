@@ -216,6 +216,8 @@ static const char* detectVulkan(const FFinstance* instance, FFVulkanResult* resu
         //No way to detect those using vulkan
         gpu->coreCount = FF_GPU_CORE_COUNT_UNSET;
         gpu->temperature = FF_GPU_TEMP_UNSET;
+        gpu->utilization = FF_GPU_UTILIZATION_UNSET;
+        gpu->frequencyCurrent = gpu->frequencyMax = 0;
     }
 
     //If the highest device version is lower than the instance version, use it as our vulkan version
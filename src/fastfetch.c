@@ -2,6 +2,8 @@
 #include "common/printing.h"
 #include "common/parsing.h"
 #include "common/io/io.h"
+#include "common/modules.h"
+#include "common/caching.h"
 #include "common/time.h"
 #include "util/FFvaluestore.h"
 #include "util/stringUtils.h"
@@ -10,6 +12,7 @@
 #include <ctype.h>
 #include <string.h>
 #include <inttypes.h>
+#include <sys/stat.h>
 
 #ifdef WIN32
     #include "util/windows/getline.h"
@@ -21,12 +24,29 @@ typedef struct CustomValue
     FFstrbuf value;
 } CustomValue;
 
+// Everything parseOption applied, so that the next run can replay it without reading the config files.
+// files: "<path>\0" + FFConfigSnapshotFile for every config file which was tried, in the order they were tried
+// options: "<key>\0" + 0 if the value is NULL, or 1 + "<value>\0", for every option which was applied
+typedef struct FFConfigSnapshot
+{
+    FFstrbuf files;
+    FFstrbuf options;
+} FFConfigSnapshot;
+
+typedef struct FFConfigSnapshotFile
+{
+    uint64_t mtime; // In nanoseconds
+    uint64_t size; // UINT64_MAX if the file couldn't be opened
+    uint64_t inode;
+} FFConfigSnapshotFile;
+
 // Things only needed by fastfetch
 typedef struct FFdata
 {
     FFvaluestore customValues;
     FFstrbuf structure;
     bool loadUserConfig;
+    FFConfigSnapshot* snapshot; // NULL if the options are not recorded
 } FFdata;
 
 static void constructAndPrintCommandHelpFormat(const char* name, const char* def, uint32_t numArgs, ...)
@@ -268,7 +288,7 @@ static inline void printCommandHelp(const char* command)
     }
     else if(strcasecmp(command, "cpu-format") == 0)
     {
-        constructAndPrintCommandHelpFormat("cpu", "{1} ({5}) @ {7}GHz", 8,
+        constructAndPrintCommandHelpFormat("cpu", "{1} ({5}) @ {7}GHz", 10,
             "Name",
             "Vendor",
             "Physical core count",
@@ -276,24 +296,34 @@ static inline void printCommandHelp(const char* command)
             "Online core count",
             "Min frequency",
             "Max frequency",
-            "Temperature"
+            "Temperature",
+            "Package count",
+            "Core clusters with their max frequency (hybrid CPUs)"
         );
     }
     else if(strcasecmp(command, "cpu-usage-format") == 0)
     {
-        constructAndPrintCommandHelpFormat("cpu-usage", "{0}%", 1,
-            "CPU usage without percent mark"
+        constructAndPrintCommandHelpFormat("cpu-usage", "{1}%", 4,
+            "CPU usage without percent mark (average of all cores)",
+            "Usage of the busiest core",
+            "Usage of the most idle core",
+            "Usages of all cores, rounded"
         );
     }
     else if(strcasecmp(command, "gpu-format") == 0)
     {
-        constructAndPrintCommandHelpFormat("gpu", "{} {}", 6,
+        constructAndPrintCommandHelpFormat("gpu", "{} {}", 11,
             "GPU vendor",
             "GPU name",
             "GPU driver",
             "GPU temperature",
             "GPU core count",
-            "GPU type"
+            "GPU type",
+            "GPU dedicated memory used",
+            "GPU dedicated memory total",
+            "GPU utilization in percent",
+            "GPU current frequency in GHz",
+            "GPU max frequency in GHz"
         );
     }
     else if(strcasecmp(command, "memory-format") == 0)
@@ -326,6 +356,16 @@ static inline void printCommandHelp(const char* command)
             "Filesystem"
         );
     }
+    else if(strcasecmp(command, "disk-io-format") == 0)
+    {
+        constructAndPrintCommandHelpFormat("disk-io", "{1} (R) - {2} (W), {3} / {4} IOPS", 5,
+            "Size of data read per second",
+            "Size of data written per second",
+            "Number of reads per second",
+            "Number of writes per second",
+            "Device name"
+        );
+    }
     else if(strcasecmp(command, "battery-format") == 0)
     {
         constructAndPrintCommandHelpFormat("battery", "{}%, {}", 5,
@@ -514,9 +554,50 @@ static void listDataPaths(FFinstance* instance)
 
 static void parseOption(FFinstance* instance, FFdata* data, const char* key, const char* value);
 
+static void getSnapshotFile(const struct stat* fileInfo, FFConfigSnapshotFile* file)
+{
+    file->mtime = (uint64_t) fileInfo->st_mtime * 1000000000u;
+    #if defined(__APPLE__)
+        file->mtime += (uint64_t) fileInfo->st_mtimespec.tv_nsec;
+    #elif !defined(_WIN32)
+        file->mtime += (uint64_t) fileInfo->st_mtim.tv_nsec;
+    #endif
+    file->size = (uint64_t) fileInfo->st_size;
+    file->inode = (uint64_t) fileInfo->st_ino;
+}
+
+static void snapshotAddFile(FFConfigSnapshot* snapshot, const char* path, FILE* file)
+{
+    FFConfigSnapshotFile snapshotFile = { .size = UINT64_MAX };
+    struct stat fileInfo;
+    if(file != NULL && fstat(fileno(file), &fileInfo) == 0)
+        getSnapshotFile(&fileInfo, &snapshotFile);
+
+    ffStrbufAppendS(&snapshot->files, path);
+    ffStrbufAppendC(&snapshot->files, '\0');
+    ffStrbufAppendNS(&snapshot->files, sizeof(snapshotFile), (const char*) &snapshotFile);
+}
+
+static void snapshotAddOption(FFConfigSnapshot* snapshot, const char* key, const char* value)
+{
+    ffStrbufAppendS(&snapshot->options, key);
+    ffStrbufAppendC(&snapshot->options, '\0');
+    ffStrbufAppendC(&snapshot->options, value != NULL);
+    if(value != NULL)
+    {
+        ffStrbufAppendS(&snapshot->options, value);
+        ffStrbufAppendC(&snapshot->options, '\0');
+    }
+}
+
 static bool parseConfigFile(FFinstance* instance, FFdata* data, const char* path)
 {
     FILE* file = fopen(path, "r");
+
+    //A file which is created later must invalidate the snapshot too, so failed attempts are recorded as well
+    if(data->snapshot != NULL)
+        snapshotAddFile(data->snapshot, path, file);
+
     if(file == NULL)
         return false;
 
@@ -723,7 +804,7 @@ static void optionParseCustomValue(FFdata* data, const char* key, const char* va
         exit(411);
     }
 
-    char* separator = strchr(value, '=');
+    const char* separator = strchr(value, '=');
 
     if(separator == NULL)
     {
@@ -731,17 +812,25 @@ static void optionParseCustomValue(FFdata* data, const char* key, const char* va
         exit(412);
     }
 
-    *separator = '\0';
+    //value may point into the read only snapshot, so the key is copied instead of terminated in place
+    FF_STRBUF_AUTO_DESTROY customKey;
+    ffStrbufInitNS(&customKey, (uint32_t) (separator - value), value);
 
     bool created;
-    CustomValue* customValue = ffValuestoreSet(&data->customValues, value, &created);
+    CustomValue* customValue = ffValuestoreSet(&data->customValues, customKey.chars, &created);
     if(created)
         ffStrbufInit(&customValue->value);
     ffStrbufSetS(&customValue->value, separator + 1);
     customValue->printKey = printKey;
 }
 
-static void optionParseEnum(const char* argumentKey, const char* requestedKey, void* result, ...)
+typedef struct FFOptionEnumValue
+{
+    const char* name;
+    int value; //C standard guarantees that enumeration constants are presented as ints
+} FFOptionEnumValue;
+
+static void optionParseEnum(const char* argumentKey, const char* requestedKey, int* result, const FFOptionEnumValue* values)
 {
     if(requestedKey == NULL)
     {
@@ -749,67 +838,297 @@ static void optionParseEnum(const char* argumentKey, const char* requestedKey, v
         exit(476);
     }
 
-    va_list args;
-    va_start(args, result);
-
-    while(true)
+    for(; values->name != NULL; ++values)
     {
-        const char* key = va_arg(args, const char*);
-        if(key == NULL)
-            break;
-
-        int value = va_arg(args, int); //C standard guarantees that enumeration constants are presented as ints
-
-        if(strcasecmp(requestedKey, key) == 0)
+        if(strcasecmp(requestedKey, values->name) == 0)
         {
-            *(int*)result = value;
-            va_end(args);
+            *result = values->value;
             return;
         }
     }
 
-    va_end(args);
-
     fprintf(stderr, "Error: unknown %s value: %s\n", argumentKey, requestedKey);
     exit(478);
 }
 
-static bool optionParseModuleArgs(const char* argumentKey, const char* value, const char* moduleName, struct FFModuleArgs* result)
+typedef enum FFOptionType
 {
-    const char* pkey = argumentKey;
-    if(!(pkey[0] == '-' && pkey[1] == '-'))
-        return false;
+    FF_OPTION_TYPE_BOOL,
+    FF_OPTION_TYPE_UINT32,
+    FF_OPTION_TYPE_STRING,
+    FF_OPTION_TYPE_COLOR,
+    FF_OPTION_TYPE_ENUM,
+    FF_OPTION_TYPE_LOGO, //Sets the logo source and the logo type
+} FFOptionType;
+
+typedef struct FFOption
+{
+    const char* name;
+    FFOptionType type;
+    size_t offset; //Target in FFconfig
+    const FFOptionEnumValue* enumValues; //FF_OPTION_TYPE_ENUM, terminated by a NULL name
+    FFLogoType logoType; //FF_OPTION_TYPE_LOGO
+} FFOption;
+
+#define FF_OPTION(optionName, optionType, member) { optionName, optionType, offsetof(FFconfig, member), NULL, FF_LOGO_TYPE_AUTO }
+#define FF_OPTION_ENUM(optionName, member, values) { optionName, FF_OPTION_TYPE_ENUM, offsetof(FFconfig, member), values, FF_LOGO_TYPE_AUTO }
+#define FF_OPTION_LOGO(optionName, type) { optionName, FF_OPTION_TYPE_LOGO, offsetof(FFconfig, logo.source), NULL, type }
+
+static const FFOptionEnumValue logoTypeValues[] = {
+    { "auto", FF_LOGO_TYPE_AUTO },
+    { "builtin", FF_LOGO_TYPE_BUILTIN },
+    { "file", FF_LOGO_TYPE_FILE },
+    { "file-raw", FF_LOGO_TYPE_FILE_RAW },
+    { "data", FF_LOGO_TYPE_DATA },
+    { "data-raw", FF_LOGO_TYPE_DATA_RAW },
+    { "sixel", FF_LOGO_TYPE_IMAGE_SIXEL },
+    { "kitty", FF_LOGO_TYPE_IMAGE_KITTY },
+    { "iterm", FF_LOGO_TYPE_IMAGE_ITERM },
+    { "chafa", FF_LOGO_TYPE_IMAGE_CHAFA },
+    { "raw", FF_LOGO_TYPE_IMAGE_RAW },
+    { "none", FF_LOGO_TYPE_NONE },
+    { NULL, 0 }
+};
+
+static const FFOptionEnumValue binaryPrefixValues[] = {
+    { "iec", FF_BINARY_PREFIX_TYPE_IEC },
+    { "si", FF_BINARY_PREFIX_TYPE_SI },
+    { "jedec", FF_BINARY_PREFIX_TYPE_JEDEC },
+    { NULL, 0 }
+};
+
+static const FFOptionEnumValue soundTypeValues[] = {
+    { "main", FF_SOUND_TYPE_MAIN },
+    { "active", FF_SOUND_TYPE_ACTIVE },
+    { "all", FF_SOUND_TYPE_ALL },
+    { NULL, 0 }
+};
+
+static const FFOptionEnumValue localIpCompactTypeValues[] = {
+    { "none", FF_LOCALIP_COMPACT_TYPE_NONE },
+    { "oneline", FF_LOCALIP_COMPACT_TYPE_ONELINE },
+    { "multiline", FF_LOCALIP_COMPACT_TYPE_MULTILINE },
+    { NULL, 0 }
+};
+
+static const FFOptionEnumValue glTypeValues[] = {
+    { "auto", FF_GL_TYPE_AUTO },
+    { "egl", FF_GL_TYPE_EGL },
+    { "glx", FF_GL_TYPE_GLX },
+    { "osmesa", FF_GL_TYPE_OSMESA },
+    { NULL, 0 }
+};
+
+//Options which only set a value in FFconfig. Options with side effects are handled in parseOption
+static const FFOption options[] = {
+    //General options
+    FF_OPTION("-r", FF_OPTION_TYPE_BOOL, recache),
+    FF_OPTION("--recache", FF_OPTION_TYPE_BOOL, recache),
+    FF_OPTION("--thread", FF_OPTION_TYPE_BOOL, multithreading),
+    FF_OPTION("--multithreading", FF_OPTION_TYPE_BOOL, multithreading),
+    FF_OPTION("--allow-slow-operations", FF_OPTION_TYPE_BOOL, allowSlowOperations),
+    FF_OPTION("--escape-bedrock", FF_OPTION_TYPE_BOOL, escapeBedrock),
+    FF_OPTION("--pipe", FF_OPTION_TYPE_BOOL, pipe),
+
+    //Logo options
+    FF_OPTION_ENUM("--logo-type", logo.type, logoTypeValues),
+    FF_OPTION("--logo-width", FF_OPTION_TYPE_UINT32, logo.width),
+    FF_OPTION("--logo-height", FF_OPTION_TYPE_UINT32, logo.height),
+    FF_OPTION("--logo-padding-top", FF_OPTION_TYPE_UINT32, logo.paddingTop),
+    FF_OPTION("--logo-padding-left", FF_OPTION_TYPE_UINT32, logo.paddingLeft),
+    FF_OPTION("--logo-padding-right", FF_OPTION_TYPE_UINT32, logo.paddingRight),
+    FF_OPTION("--logo-print-remaining", FF_OPTION_TYPE_BOOL, logo.printRemaining),
+    FF_OPTION("--logo-preserve-aspect-radio", FF_OPTION_TYPE_BOOL, logo.preserveAspectRadio),
+    FF_OPTION_LOGO("--file", FF_LOGO_TYPE_FILE),
+    FF_OPTION_LOGO("--file-raw", FF_LOGO_TYPE_FILE_RAW),
+    FF_OPTION_LOGO("--data", FF_LOGO_TYPE_DATA),
+    FF_OPTION_LOGO("--data-raw", FF_LOGO_TYPE_DATA_RAW),
+    FF_OPTION_LOGO("--sixel", FF_LOGO_TYPE_IMAGE_SIXEL),
+    FF_OPTION_LOGO("--kitty", FF_LOGO_TYPE_IMAGE_KITTY),
+    FF_OPTION_LOGO("--chafa", FF_LOGO_TYPE_IMAGE_CHAFA),
+    FF_OPTION_LOGO("--iterm", FF_LOGO_TYPE_IMAGE_ITERM),
+    FF_OPTION_LOGO("--raw", FF_LOGO_TYPE_IMAGE_RAW),
+    FF_OPTION("--chafa-fg-only", FF_OPTION_TYPE_BOOL, logo.chafaFgOnly),
+    FF_OPTION("--chafa-symbols", FF_OPTION_TYPE_STRING, logo.chafaSymbols),
+    FF_OPTION("--chafa-canvas-mode", FF_OPTION_TYPE_UINT32, logo.chafaCanvasMode),
+    FF_OPTION("--chafa-color-space", FF_OPTION_TYPE_UINT32, logo.chafaColorSpace),
+    FF_OPTION("--chafa-dither-mode", FF_OPTION_TYPE_UINT32, logo.chafaDitherMode),
+
+    //Display options
+    FF_OPTION("--show-errors", FF_OPTION_TYPE_BOOL, showErrors),
+    FF_OPTION("--disable-linewrap", FF_OPTION_TYPE_BOOL, disableLinewrap),
+    FF_OPTION("--hide-cursor", FF_OPTION_TYPE_BOOL, hideCursor),
+    FF_OPTION("--separator", FF_OPTION_TYPE_STRING, separator),
+    FF_OPTION("--color-keys", FF_OPTION_TYPE_COLOR, colorKeys),
+    FF_OPTION("--color-title", FF_OPTION_TYPE_COLOR, colorTitle),
+    FF_OPTION_ENUM("--binary-prefix", binaryPrefixType, binaryPrefixValues),
+
+    //Library options
+    FF_OPTION("--lib-PCI", FF_OPTION_TYPE_STRING, libPCI),
+    FF_OPTION("--lib-vulkan", FF_OPTION_TYPE_STRING, libVulkan),
+    FF_OPTION("--lib-freetype", FF_OPTION_TYPE_STRING, libfreetype),
+    FF_OPTION("--lib-wayland", FF_OPTION_TYPE_STRING, libWayland),
+    FF_OPTION("--lib-xcb-randr", FF_OPTION_TYPE_STRING, libXcbRandr),
+    FF_OPTION("--lib-xcb", FF_OPTION_TYPE_STRING, libXcb),
+    FF_OPTION("--lib-Xrandr", FF_OPTION_TYPE_STRING, libXrandr),
+    FF_OPTION("--lib-X11", FF_OPTION_TYPE_STRING, libX11),
+    FF_OPTION("--lib-gio", FF_OPTION_TYPE_STRING, libGIO),
+    FF_OPTION("--lib-DConf", FF_OPTION_TYPE_STRING, libDConf),
+    FF_OPTION("--lib-dbus", FF_OPTION_TYPE_STRING, libDBus),
+    FF_OPTION("--lib-XFConf", FF_OPTION_TYPE_STRING, libXFConf),
+    FF_OPTION("--lib-sqlite", FF_OPTION_TYPE_STRING, libSQLite3),
+    FF_OPTION("--lib-sqlite3", FF_OPTION_TYPE_STRING, libSQLite3),
+    FF_OPTION("--lib-rpm", FF_OPTION_TYPE_STRING, librpm),
+    FF_OPTION("--lib-imagemagick", FF_OPTION_TYPE_STRING, libImageMagick),
+    FF_OPTION("--lib-z", FF_OPTION_TYPE_STRING, libZ),
+    FF_OPTION("--lib-chafa", FF_OPTION_TYPE_STRING, libChafa),
+    FF_OPTION("--lib-egl", FF_OPTION_TYPE_STRING, libEGL),
+    FF_OPTION("--lib-glx", FF_OPTION_TYPE_STRING, libGLX),
+    FF_OPTION("--lib-osmesa", FF_OPTION_TYPE_STRING, libOSMesa),
+    FF_OPTION("--lib-opencl", FF_OPTION_TYPE_STRING, libOpenCL),
+    FF_OPTION("--lib-jsonc", FF_OPTION_TYPE_STRING, libJSONC),
+    FF_OPTION("--lib-wlanapi", FF_OPTION_TYPE_STRING, libwlanapi),
+    FF_OPTION("--lib-pulse", FF_OPTION_TYPE_STRING, libPulse),
+    FF_OPTION("--lib-nm", FF_OPTION_TYPE_STRING, libnm),
+
+    //Module options
+    FF_OPTION("--cpu-usage-min-interval", FF_OPTION_TYPE_UINT32, cpuUsageMinInterval),
+    FF_OPTION("--cpu-temp", FF_OPTION_TYPE_BOOL, cpuTemp),
+    FF_OPTION("--gpu-temp", FF_OPTION_TYPE_BOOL, gpuTemp),
+    FF_OPTION("--battery-temp", FF_OPTION_TYPE_BOOL, batteryTemp),
+    FF_OPTION("--gpu-hide-integrated", FF_OPTION_TYPE_BOOL, gpuHideIntegrated),
+    FF_OPTION("--gpu-hide-discrete", FF_OPTION_TYPE_BOOL, gpuHideDiscrete),
+    FF_OPTION("--title-fqdn", FF_OPTION_TYPE_BOOL, titleFQDN),
+    FF_OPTION("--shell-version", FF_OPTION_TYPE_BOOL, shellVersion),
+    FF_OPTION("--terminal-version", FF_OPTION_TYPE_BOOL, terminalVersion),
+    FF_OPTION("--disk-folders", FF_OPTION_TYPE_STRING, diskFolders),
+    FF_OPTION("--disk-show-removable", FF_OPTION_TYPE_BOOL, diskShowRemovable),
+    FF_OPTION("--disk-show-hidden", FF_OPTION_TYPE_BOOL, diskShowHidden),
+    FF_OPTION("--disk-show-subvolumes", FF_OPTION_TYPE_BOOL, diskShowSubvolumes),
+    FF_OPTION("--disk-show-unknown", FF_OPTION_TYPE_BOOL, diskShowUnknown),
+    FF_OPTION("--bluetooth-show-disconnected", FF_OPTION_TYPE_BOOL, bluetoothShowDisconnected),
+    FF_OPTION_ENUM("--sound-type", soundType, soundTypeValues),
+    FF_OPTION("--battery-dir", FF_OPTION_TYPE_STRING, batteryDir),
+    FF_OPTION("--separator-string", FF_OPTION_TYPE_STRING, separatorString),
+    FF_OPTION("--localip-v6first", FF_OPTION_TYPE_BOOL, localIpV6First),
+    FF_OPTION("--localip-show-ipv4", FF_OPTION_TYPE_BOOL, localIpShowIpV4),
+    FF_OPTION("--localip-show-ipv6", FF_OPTION_TYPE_BOOL, localIpShowIpV6),
+    FF_OPTION("--localip-show-loop", FF_OPTION_TYPE_BOOL, localIpShowLoop),
+    FF_OPTION("--localip-name-prefix", FF_OPTION_TYPE_STRING, localIpNamePrefix),
+    FF_OPTION_ENUM("--localip-compact-type", localIpCompactType, localIpCompactTypeValues),
+    FF_OPTION("--os-file", FF_OPTION_TYPE_STRING, osFile),
+    FF_OPTION("--player-name", FF_OPTION_TYPE_STRING, playerName),
+    FF_OPTION("--public-ip-url", FF_OPTION_TYPE_STRING, publicIpUrl),
+    FF_OPTION("--public-ip-timeout", FF_OPTION_TYPE_UINT32, publicIpTimeout),
+    FF_OPTION("--weather-output-format", FF_OPTION_TYPE_STRING, weatherOutputFormat),
+    FF_OPTION("--weather-timeout", FF_OPTION_TYPE_UINT32, weatherTimeout),
+    FF_OPTION_ENUM("--gl", glType, glTypeValues),
+    FF_OPTION("--percent-type", FF_OPTION_TYPE_UINT32, percentType),
+    FF_OPTION("--command-shell", FF_OPTION_TYPE_STRING, commandShell),
+};
+
+#undef FF_OPTION
+#undef FF_OPTION_ENUM
+#undef FF_OPTION_LOGO
+
+//Index of the names of options and of the option names of modules, which can't collide because option names start with "--".
+//It is built once, so adding an option never needs a generated table.
+#define FF_OPTION_INDEX_MODULE 0x8000 //Marks ffModules indices in the index
+
+static uint16_t optionIndexFind(const char* name, size_t length, bool module)
+{
+    static FFhashmap optionIndex; //Index + 1 into options or ffModules
+    if(optionIndex.entries.elementSize == 0)
+    {
+        ffHashmapInit(&optionIndex, sizeof(uint16_t), true);
+        for(uint16_t i = 0; i < sizeof(options) / sizeof(options[0]); ++i)
+            *(uint16_t*) ffHashmapSetS(&optionIndex, options[i].name, NULL) = (uint16_t) (i + 1);
+        for(uint16_t i = 0; i < ffModulesCount; ++i)
+        {
+            if(ffModules[i].optionName != NULL)
+                *(uint16_t*) ffHashmapSetS(&optionIndex, ffModules[i].optionName, NULL) = (uint16_t) ((i + 1) | FF_OPTION_INDEX_MODULE);
+        }
+    }
 
-    pkey += 2;
-    uint32_t moduleNameLen = (uint32_t)strlen(moduleName);
-    if(strncasecmp(pkey, moduleName, moduleNameLen) != 0)
-        return false;
+    const uint16_t* entry = ffHashmapGet(&optionIndex, (uint32_t) length, name);
+    if(entry == NULL || !!(*entry & FF_OPTION_INDEX_MODULE) != module)
+        return 0;
+    return *entry;
+}
 
-    pkey += moduleNameLen;
-    if(pkey[0] != '-')
+static bool optionParseTable(FFinstance* instance, const char* key, const char* value)
+{
+    uint16_t entry = optionIndexFind(key, strlen(key), false);
+    if(entry == 0)
         return false;
 
-    pkey += 1;
-    if(strcasecmp(pkey, "key") == 0)
-    {
-        optionParseString(argumentKey, value, &result->key);
-        return true;
-    }
-    else if(strcasecmp(pkey, "format") == 0)
+    const FFOption* option = &options[entry - 1];
+    void* target = (char*) &instance->config + option->offset;
+    switch(option->type)
     {
-        optionParseString(argumentKey, value, &result->outputFormat);
-        return true;
-    }
-    else if(strcasecmp(pkey, "error") == 0)
-    {
-        optionParseString(argumentKey, value, &result->errorFormat);
-        return true;
+        case FF_OPTION_TYPE_BOOL:
+            *(bool*) target = optionParseBoolean(value);
+            break;
+        case FF_OPTION_TYPE_UINT32:
+            *(uint32_t*) target = optionParseUInt32(key, value);
+            break;
+        case FF_OPTION_TYPE_STRING:
+            optionParseString(key, value, (FFstrbuf*) target);
+            break;
+        case FF_OPTION_TYPE_COLOR:
+            optionParseColor(key, value, (FFstrbuf*) target);
+            break;
+        case FF_OPTION_TYPE_ENUM:
+            optionParseEnum(key, value, (int*) target, option->enumValues);
+            break;
+        case FF_OPTION_TYPE_LOGO:
+            optionParseString(key, value, (FFstrbuf*) target);
+            instance->config.logo.type = option->logoType;
+            break;
     }
-    return false;
+    return true;
+}
+
+//--<module>-key, --<module>-format and --<module>-error
+static bool optionParseModuleArgs(FFinstance* instance, const char* key, const char* value)
+{
+    if(key[0] != '-' || key[1] != '-')
+        return false;
+
+    const char* name = key + 2;
+    const char* suffix = strrchr(name, '-');
+    if(suffix == NULL)
+        return false;
+
+    FFstrbuf* target;
+    uint16_t entry = optionIndexFind(name, (size_t) (suffix - name), true);
+    if(entry == 0)
+        return false;
+
+    FFModuleArgs* args = ffModuleGetArgs(&instance->config, &ffModules[(entry & ~FF_OPTION_INDEX_MODULE) - 1]);
+    if(strcasecmp(suffix, "-key") == 0)
+        target = &args->key;
+    else if(strcasecmp(suffix, "-format") == 0)
+        target = &args->outputFormat;
+    else if(strcasecmp(suffix, "-error") == 0)
+        target = &args->errorFormat;
+    else
+        return false;
+
+    optionParseString(key, value, target);
+    return true;
 }
 
 static void parseOption(FFinstance* instance, FFdata* data, const char* key, const char* value)
 {
+    //The options of the loaded file are recorded instead
+    if(data->snapshot != NULL && strcasecmp(key, "--load-config") != 0)
+        snapshotAddOption(data->snapshot, key, value);
+
+    //Options which only set a value, which are most options of config files
+    if(optionParseTable(instance, key, value) || optionParseModuleArgs(instance, key, value))
+        return;
+
     ///////////////////////
     //Informative options//
     ///////////////////////
@@ -934,27 +1253,17 @@ static void parseOption(FFinstance* instance, FFdata* data, const char* key, con
     //General options//
     ///////////////////
 
-    else if(strcasecmp(key, "-r") == 0 || strcasecmp(key, "--recache") == 0)
-        instance->config.recache = optionParseBoolean(value);
     else if(strcasecmp(key, "--load-config") == 0)
         optionParseConfigFile(instance, data, key, value);
     else if(strcasecmp(key, "--gen-config") == 0)
         generateConfigFile(instance, false);
     else if(strcasecmp(key, "--gen-config-force") == 0)
         generateConfigFile(instance, true);
-    else if(strcasecmp(key, "--thread") == 0 || strcasecmp(key, "--multithreading") == 0)
-        instance->config.multithreading = optionParseBoolean(value);
     else if(strcasecmp(key, "--stat") == 0)
     {
         if((instance->config.stat = optionParseBoolean(value)))
             instance->config.showErrors = true;
     }
-    else if(strcasecmp(key, "--allow-slow-operations") == 0)
-        instance->config.allowSlowOperations = optionParseBoolean(value);
-    else if(strcasecmp(key, "--escape-bedrock") == 0)
-        instance->config.escapeBedrock = optionParseBoolean(value);
-    else if(strcasecmp(key, "--pipe") == 0)
-        instance->config.pipe = optionParseBoolean(value);
     else if(strcasecmp(key, "--load-user-config") == 0)
         data->loadUserConfig = optionParseBoolean(value);
 
@@ -978,25 +1287,7 @@ static void parseOption(FFinstance* instance, FFdata* data, const char* key, con
     else if(startsWith(key, "--logo"))
     {
         const char* subkey = key + strlen("--logo");
-        if(strcasecmp(subkey, "-type") == 0)
-        {
-            optionParseEnum(key, value, &instance->config.logo.type,
-                "auto", FF_LOGO_TYPE_AUTO,
-                "builtin", FF_LOGO_TYPE_BUILTIN,
-                "file", FF_LOGO_TYPE_FILE,
-                "file-raw", FF_LOGO_TYPE_FILE_RAW,
-                "data", FF_LOGO_TYPE_DATA,
-                "data-raw", FF_LOGO_TYPE_DATA_RAW,
-                "sixel", FF_LOGO_TYPE_IMAGE_SIXEL,
-                "kitty", FF_LOGO_TYPE_IMAGE_KITTY,
-                "iterm", FF_LOGO_TYPE_IMAGE_ITERM,
-                "chafa", FF_LOGO_TYPE_IMAGE_CHAFA,
-                "raw", FF_LOGO_TYPE_IMAGE_RAW,
-                "none", FF_LOGO_TYPE_NONE,
-                NULL
-            );
-        }
-        else if(startsWith(subkey, "-color-") && key[13] != '\0' && key[14] == '\0') // matches "--logo-color-*"
+        if(startsWith(subkey, "-color-") && key[13] != '\0' && key[14] == '\0') // matches "--logo-color-*"
         {
             //Map the number to an array index, so that '1' -> 0, '2' -> 1, etc.
             int index = (int)key[13] - 49;
@@ -1010,103 +1301,22 @@ static void parseOption(FFinstance* instance, FFdata* data, const char* key, con
 
             optionParseColor(key, value, &instance->config.logo.colors[index]);
         }
-        else if(strcasecmp(subkey, "-width") == 0)
-            instance->config.logo.width = optionParseUInt32(key, value);
-        else if(strcasecmp(subkey, "-height") == 0)
-            instance->config.logo.height = optionParseUInt32(key, value);
         else if(strcasecmp(subkey, "-padding") == 0)
         {
             uint32_t padding = optionParseUInt32(key, value);
             instance->config.logo.paddingLeft = padding;
             instance->config.logo.paddingRight = padding;
         }
-        else if(strcasecmp(subkey, "-padding-top") == 0)
-            instance->config.logo.paddingTop = optionParseUInt32(key, value);
-        else if(strcasecmp(subkey, "-padding-left") == 0)
-            instance->config.logo.paddingLeft = optionParseUInt32(key, value);
-        else if(strcasecmp(subkey, "-padding-right") == 0)
-            instance->config.logo.paddingRight = optionParseUInt32(key, value);
-        else if(strcasecmp(subkey, "-print-remaining") == 0)
-            instance->config.logo.printRemaining = optionParseBoolean(value);
-        else if(strcasecmp(subkey, "-preserve-aspect-radio") == 0)
-            instance->config.logo.preserveAspectRadio = optionParseBoolean(value);
         else
             goto error;
     }
-    else if(strcasecmp(key, "--file") == 0)
-    {
-        optionParseString(key, value, &instance->config.logo.source);
-        instance->config.logo.type = FF_LOGO_TYPE_FILE;
-    }
-    else if(strcasecmp(key, "--file-raw") == 0)
-    {
-        optionParseString(key, value, &instance->config.logo.source);
-        instance->config.logo.type = FF_LOGO_TYPE_FILE_RAW;
-    }
-    else if(strcasecmp(key, "--data") == 0)
-    {
-        optionParseString(key, value, &instance->config.logo.source);
-        instance->config.logo.type = FF_LOGO_TYPE_DATA;
-    }
-    else if(strcasecmp(key, "--data-raw") == 0)
-    {
-        optionParseString(key, value, &instance->config.logo.source);
-        instance->config.logo.type = FF_LOGO_TYPE_DATA_RAW;
-    }
-    else if(strcasecmp(key, "--sixel") == 0)
-    {
-        optionParseString(key, value, &instance->config.logo.source);
-        instance->config.logo.type = FF_LOGO_TYPE_IMAGE_SIXEL;
-    }
-    else if(strcasecmp(key, "--kitty") == 0)
-    {
-        optionParseString(key, value, &instance->config.logo.source);
-        instance->config.logo.type = FF_LOGO_TYPE_IMAGE_KITTY;
-    }
-    else if(strcasecmp(key, "--chafa") == 0)
-    {
-        optionParseString(key, value, &instance->config.logo.source);
-        instance->config.logo.type = FF_LOGO_TYPE_IMAGE_CHAFA;
-    }
-    else if(strcasecmp(key, "--iterm") == 0)
-    {
-        optionParseString(key, value, &instance->config.logo.source);
-        instance->config.logo.type = FF_LOGO_TYPE_IMAGE_ITERM;
-    }
-    else if(strcasecmp(key, "--raw") == 0)
-    {
-        optionParseString(key, value, &instance->config.logo.source);
-        instance->config.logo.type = FF_LOGO_TYPE_IMAGE_RAW;
-    }
-    else if(strcasecmp(key, "--chafa-fg-only") == 0)
-        instance->config.logo.chafaFgOnly = optionParseBoolean(value);
-    else if(strcasecmp(key, "--chafa-symbols") == 0)
-        optionParseString(key, value, &instance->config.logo.chafaSymbols);
-    else if(strcasecmp(key, "--chafa-canvas-mode") == 0)
-        instance->config.logo.chafaCanvasMode = optionParseUInt32(key, value);
-    else if(strcasecmp(key, "--chafa-color-space") == 0)
-        instance->config.logo.chafaColorSpace = optionParseUInt32(key, value);
-    else if(strcasecmp(key, "--chafa-dither-mode") == 0)
-        instance->config.logo.chafaDitherMode = optionParseUInt32(key, value);
 
     ///////////////////
     //Display options//
     ///////////////////
 
-    else if(strcasecmp(key, "--show-errors") == 0)
-        instance->config.showErrors = optionParseBoolean(value);
-    else if(strcasecmp(key, "--disable-linewrap") == 0)
-        instance->config.disableLinewrap = optionParseBoolean(value);
-    else if(strcasecmp(key, "--hide-cursor") == 0)
-        instance->config.hideCursor = optionParseBoolean(value);
     else if(strcasecmp(key, "-s") == 0 || strcasecmp(key, "--structure") == 0)
         optionParseString(key, value, &data->structure);
-    else if(strcasecmp(key, "--separator") == 0)
-        optionParseString(key, value, &instance->config.separator);
-    else if(strcasecmp(key, "--color-keys") == 0)
-        optionParseColor(key, value, &instance->config.colorKeys);
-    else if(strcasecmp(key, "--color-title") == 0)
-        optionParseColor(key, value, &instance->config.colorTitle);
     else if(strcasecmp(key, "-c") == 0 || strcasecmp(key, "--color") == 0)
     {
         optionParseColor(key, value, &instance->config.colorKeys);
@@ -1116,228 +1326,21 @@ static void parseOption(FFinstance* instance, FFdata* data, const char* key, con
         optionParseCustomValue(data, key, value, true);
     else if(strcasecmp(key, "--set-keyless") == 0)
         optionParseCustomValue(data, key, value, false);
-    else if(strcasecmp(key, "--binary-prefix") == 0)
-    {
-        optionParseEnum(key, value, &instance->config.binaryPrefixType,
-            "iec", FF_BINARY_PREFIX_TYPE_IEC,
-            "si", FF_BINARY_PREFIX_TYPE_SI,
-            "jedec", FF_BINARY_PREFIX_TYPE_JEDEC,
-            NULL
-        );
-    }
-
-    ///////////////////////
-    //Module args options//
-    ///////////////////////
-
-    else if(optionParseModuleArgs(key, value, "os", &instance->config.os)) {}
-    else if(optionParseModuleArgs(key, value, "host", &instance->config.host)) {}
-    else if(optionParseModuleArgs(key, value, "bios", &instance->config.bios)) {}
-    else if(optionParseModuleArgs(key, value, "board", &instance->config.board)) {}
-    else if(optionParseModuleArgs(key, value, "chassis", &instance->config.chassis)) {}
-    else if(optionParseModuleArgs(key, value, "kernel", &instance->config.kernel)) {}
-    else if(optionParseModuleArgs(key, value, "uptime", &instance->config.uptime)) {}
-    else if(optionParseModuleArgs(key, value, "processes", &instance->config.processes)) {}
-    else if(optionParseModuleArgs(key, value, "packages", &instance->config.packages)) {}
-    else if(optionParseModuleArgs(key, value, "shell", &instance->config.shell)) {}
-    else if(optionParseModuleArgs(key, value, "display", &instance->config.display)) {}
-    else if(optionParseModuleArgs(key, value, "brightness", &instance->config.brightness)) {}
-    else if(optionParseModuleArgs(key, value, "de", &instance->config.de)) {}
-    else if(optionParseModuleArgs(key, value, "wifi", &instance->config.wifi)) {}
-    else if(optionParseModuleArgs(key, value, "wm", &instance->config.wm)) {}
-    else if(optionParseModuleArgs(key, value, "wm-theme", &instance->config.wmTheme)) {}
-    else if(optionParseModuleArgs(key, value, "theme", &instance->config.theme)) {}
-    else if(optionParseModuleArgs(key, value, "icons", &instance->config.icons)) {}
-    else if(optionParseModuleArgs(key, value, "font", &instance->config.font)) {}
-    else if(optionParseModuleArgs(key, value, "cursor", &instance->config.cursor)) {}
-    else if(optionParseModuleArgs(key, value, "terminal", &instance->config.terminal)) {}
-    else if(optionParseModuleArgs(key, value, "terminal-font", &instance->config.terminalFont)) {}
-    else if(optionParseModuleArgs(key, value, "cpu", &instance->config.cpu)) {}
-    else if(optionParseModuleArgs(key, value, "cpu-usage", &instance->config.cpuUsage)) {}
-    else if(optionParseModuleArgs(key, value, "gpu", &instance->config.gpu)) {}
-    else if(optionParseModuleArgs(key, value, "memory", &instance->config.memory)) {}
-    else if(optionParseModuleArgs(key, value, "swap", &instance->config.swap)) {}
-    else if(optionParseModuleArgs(key, value, "disk", &instance->config.disk)) {}
-    else if(optionParseModuleArgs(key, value, "battery", &instance->config.battery)) {}
-    else if(optionParseModuleArgs(key, value, "poweradapter", &instance->config.powerAdapter)) {}
-    else if(optionParseModuleArgs(key, value, "locale", &instance->config.locale)) {}
-    else if(optionParseModuleArgs(key, value, "local-ip", &instance->config.localIP)) {}
-    else if(optionParseModuleArgs(key, value, "public-ip", &instance->config.publicIP)) {}
-    else if(optionParseModuleArgs(key, value, "weather", &instance->config.weather)) {}
-    else if(optionParseModuleArgs(key, value, "player", &instance->config.player)) {}
-    else if(optionParseModuleArgs(key, value, "media", &instance->config.media)) {}
-    else if(optionParseModuleArgs(key, value, "datetime", &instance->config.dateTime)) {}
-    else if(optionParseModuleArgs(key, value, "date", &instance->config.date)) {}
-    else if(optionParseModuleArgs(key, value, "time", &instance->config.time)) {}
-    else if(optionParseModuleArgs(key, value, "vulkan", &instance->config.vulkan)) {}
-    else if(optionParseModuleArgs(key, value, "opengl", &instance->config.openGL)) {}
-    else if(optionParseModuleArgs(key, value, "opencl", &instance->config.openCL)) {}
-    else if(optionParseModuleArgs(key, value, "users", &instance->config.users)) {}
-    else if(optionParseModuleArgs(key, value, "bluetooth", &instance->config.bluetooth)) {}
-    else if(optionParseModuleArgs(key, value, "sound", &instance->config.sound)) {}
-    else if(optionParseModuleArgs(key, value, "gamepad", &instance->config.gamepad)) {}
-
-    ///////////////////
-    //Library options//
-    ///////////////////
-
-    else if(startsWith(key, "--lib"))
-    {
-        const char* subkey = key + strlen("--lib");
-        if(strcasecmp(subkey, "-PCI") == 0)
-            optionParseString(key, value, &instance->config.libPCI);
-        else if(strcasecmp(subkey, "-vulkan") == 0)
-            optionParseString(key, value, &instance->config.libVulkan);
-        else if(strcasecmp(subkey, "-freetype") == 0)
-            optionParseString(key, value, &instance->config.libfreetype);
-        else if(strcasecmp(subkey, "-wayland") == 0)
-            optionParseString(key, value, &instance->config.libWayland);
-        else if(strcasecmp(subkey, "-xcb-randr") == 0)
-            optionParseString(key, value, &instance->config.libXcbRandr);
-        else if(strcasecmp(subkey, "-xcb") == 0)
-            optionParseString(key, value, &instance->config.libXcb);
-        else if(strcasecmp(subkey, "-Xrandr") == 0)
-            optionParseString(key, value, &instance->config.libXrandr);
-        else if(strcasecmp(subkey, "-X11") == 0)
-            optionParseString(key, value, &instance->config.libX11);
-        else if(strcasecmp(subkey, "-gio") == 0)
-            optionParseString(key, value, &instance->config.libGIO);
-        else if(strcasecmp(subkey, "-DConf") == 0)
-            optionParseString(key, value, &instance->config.libDConf);
-        else if(strcasecmp(subkey, "-dbus") == 0)
-            optionParseString(key, value, &instance->config.libDBus);
-        else if(strcasecmp(subkey, "-XFConf") == 0)
-            optionParseString(key, value, &instance->config.libXFConf);
-        else if(strcasecmp(subkey, "-sqlite") == 0 || strcasecmp(subkey, "-sqlite3") == 0)
-            optionParseString(key, value, &instance->config.libSQLite3);
-        else if(strcasecmp(subkey, "-rpm") == 0)
-            optionParseString(key, value, &instance->config.librpm);
-        else if(strcasecmp(subkey, "-imagemagick") == 0)
-            optionParseString(key, value, &instance->config.libImageMagick);
-        else if(strcasecmp(subkey, "-z") == 0)
-            optionParseString(key, value, &instance->config.libZ);
-        else if(strcasecmp(subkey, "-chafa") == 0)
-            optionParseString(key, value, &instance->config.libChafa);
-        else if(strcasecmp(subkey, "-egl") == 0)
-            optionParseString(key, value, &instance->config.libEGL);
-        else if(strcasecmp(subkey, "-glx") == 0)
-            optionParseString(key, value, &instance->config.libGLX);
-        else if(strcasecmp(subkey, "-osmesa") == 0)
-            optionParseString(key, value, &instance->config.libOSMesa);
-        else if(strcasecmp(subkey, "-opencl") == 0)
-            optionParseString(key, value, &instance->config.libOpenCL);
-        else if(strcasecmp(subkey, "-jsonc") == 0)
-            optionParseString(key, value, &instance->config.libJSONC);
-        else if(strcasecmp(subkey, "-wlanapi") == 0)
-            optionParseString(key, value, &instance->config.libwlanapi);
-        else if(strcasecmp(key, "-pulse") == 0)
-            optionParseString(key, value, &instance->config.libPulse);
-        else if(strcasecmp(subkey, "-nm") == 0)
-            optionParseString(key, value, &instance->config.libnm);
-        else
-            goto error;
-    }
 
     //////////////////
     //Module options//
     //////////////////
 
-    else if(strcasecmp(key, "--cpu-temp") == 0)
-        instance->config.cpuTemp = optionParseBoolean(value);
-    else if(strcasecmp(key, "--gpu-temp") == 0)
-        instance->config.gpuTemp = optionParseBoolean(value);
-    else if(strcasecmp(key, "--battery-temp") == 0)
-        instance->config.batteryTemp = optionParseBoolean(value);
-    else if(strcasecmp(key, "--gpu-hide-integrated") == 0)
-        instance->config.gpuHideIntegrated = optionParseBoolean(value);
-    else if(strcasecmp(key, "--gpu-hide-discrete") == 0)
-        instance->config.gpuHideDiscrete = optionParseBoolean(value);
-    else if(strcasecmp(key, "--title-fqdn") == 0)
-        instance->config.titleFQDN = optionParseBoolean(value);
-    else if(strcasecmp(key, "--shell-version") == 0)
-        instance->config.shellVersion = optionParseBoolean(value);
-    else if(strcasecmp(key, "--terminal-version") == 0)
-        instance->config.terminalVersion = optionParseBoolean(value);
-    else if(strcasecmp(key, "--disk-folders") == 0)
-        optionParseString(key, value, &instance->config.diskFolders);
-    else if(strcasecmp(key, "--disk-show-removable") == 0)
-        instance->config.diskShowRemovable = optionParseBoolean(value);
-    else if(strcasecmp(key, "--disk-show-hidden") == 0)
-        instance->config.diskShowHidden = optionParseBoolean(value);
-    else if(strcasecmp(key, "--disk-show-subvolumes") == 0)
-        instance->config.diskShowSubvolumes = optionParseBoolean(value);
-    else if(strcasecmp(key, "--disk-show-unknown") == 0)
-        instance->config.diskShowUnknown = optionParseBoolean(value);
-    else if(strcasecmp(key, "--bluetooth-show-disconnected") == 0)
-        instance->config.bluetoothShowDisconnected = optionParseBoolean(value);
-    else if(strcasecmp(key, "--sound-type") == 0)
-    {
-        optionParseEnum(key, value, &instance->config.soundType,
-            "main", FF_SOUND_TYPE_MAIN,
-            "active", FF_SOUND_TYPE_ACTIVE,
-            "all", FF_SOUND_TYPE_ALL,
-            NULL
-        );
-    }
-    else if(strcasecmp(key, "--battery-dir") == 0)
-        optionParseString(key, value, &instance->config.batteryDir);
-    else if(strcasecmp(key, "--separator-string") == 0)
-        optionParseString(key, value, &instance->config.separatorString);
-    else if(strcasecmp(key, "--localip-v6first") == 0)
-        instance->config.localIpV6First = optionParseBoolean(value);
-    else if(strcasecmp(key, "--localip-show-ipv4") == 0)
-        instance->config.localIpShowIpV4 = optionParseBoolean(value);
-    else if(strcasecmp(key, "--localip-show-ipv6") == 0)
-        instance->config.localIpShowIpV6 = optionParseBoolean(value);
-    else if(strcasecmp(key, "--localip-show-loop") == 0)
-        instance->config.localIpShowLoop = optionParseBoolean(value);
-    else if(strcasecmp(key, "--localip-name-prefix") == 0)
-        optionParseString(key, value, &instance->config.localIpNamePrefix);
-    else if(strcasecmp(key, "--localip-compact-type") == 0)
-    {
-        optionParseEnum(key, value, &instance->config.localIpCompactType,
-            "none", FF_LOCALIP_COMPACT_TYPE_NONE,
-            "oneline", FF_LOCALIP_COMPACT_TYPE_ONELINE,
-            "multiline", FF_LOCALIP_COMPACT_TYPE_MULTILINE,
-            NULL
-        );
-    }
-    else if(strcasecmp(key, "--os-file") == 0)
-        optionParseString(key, value, &instance->config.osFile);
-    else if(strcasecmp(key, "--player-name") == 0)
-        optionParseString(key, value, &instance->config.playerName);
-    else if(strcasecmp(key, "--public-ip-url") == 0)
-        optionParseString(key, value, &instance->config.publicIpUrl);
-    else if(strcasecmp(key, "--public-ip-timeout") == 0)
-        instance->config.publicIpTimeout = optionParseUInt32(key, value);
-    else if(strcasecmp(key, "--weather-output-format") == 0)
-        optionParseString(key, value, &instance->config.weatherOutputFormat);
-    else if(strcasecmp(key, "--weather-timeout") == 0)
-        instance->config.weatherTimeout = optionParseUInt32(key, value);
-    else if(strcasecmp(key, "--gl") == 0)
-    {
-        optionParseEnum(key, value, &instance->config.glType,
-            "auto", FF_GL_TYPE_AUTO,
-            "egl", FF_GL_TYPE_EGL,
-            "glx", FF_GL_TYPE_GLX,
-            "osmesa", FF_GL_TYPE_OSMESA,
-            NULL
-        );
-    }
-    else if(strcasecmp(key, "--percent-type") == 0)
-        instance->config.percentType = optionParseUInt32(key, value);
-    else if(strcasecmp(key, "--command-shell") == 0)
-        optionParseString(key, value, &instance->config.commandShell);
     else if(strcasecmp(key, "--command-key") == 0)
     {
         FFstrbuf* result = (FFstrbuf*) ffListAdd(&instance->config.commandKeys);
-        ffStrbufInit(result);
+        ffStrbufInitArena(result);
         optionParseString(key, value, result);
     }
     else if(strcasecmp(key, "--command-text") == 0)
     {
         FFstrbuf* result = (FFstrbuf*) ffListAdd(&instance->config.commandTexts);
-        ffStrbufInit(result);
+        ffStrbufInitArena(result);
         optionParseString(key, value, result);
     }
 
@@ -1390,6 +1393,147 @@ static void parseArguments(FFinstance* instance, FFdata* data, int argc, const c
     }
 }
 
+// Everything the result of parsing depends on, besides the config files themselves
+static void getConfigSnapshotKey(const FFinstance* instance, int argc, const char** argv, FFstrbuf* key)
+{
+    //The lists are separated by an empty string, which no directory is
+    FF_LIST_FOR_EACH(FFstrbuf, dir, instance->state.platform.configDirs)
+        ffStrbufAppendNS(key, dir->length + 1, dir->chars);
+    ffStrbufAppendC(key, '\0');
+
+    FF_LIST_FOR_EACH(FFstrbuf, dir, instance->state.platform.dataDirs)
+        ffStrbufAppendNS(key, dir->length + 1, dir->chars);
+    ffStrbufAppendC(key, '\0');
+
+    for(int i = 1; i < argc; i++)
+        ffStrbufAppendNS(key, (uint32_t) strlen(argv[i]) + 1, argv[i]);
+}
+
+static bool isConfigSnapshotValid(const char* files, const char* filesEnd)
+{
+    while(files < filesEnd)
+    {
+        const char* path = files;
+        files += strnlen(path, (size_t) (filesEnd - path)) + 1;
+        if(files + sizeof(FFConfigSnapshotFile) > filesEnd)
+            return false;
+
+        FFConfigSnapshotFile stored;
+        memcpy(&stored, files, sizeof(stored));
+        files += sizeof(stored);
+
+        FFConfigSnapshotFile current = { .size = UINT64_MAX };
+        struct stat fileInfo;
+        if(stat(path, &fileInfo) == 0)
+            getSnapshotFile(&fileInfo, &current);
+
+        //A file which exists but couldn't be opened is always treated as changed
+        if(stored.size == UINT64_MAX ? current.size != UINT64_MAX : memcmp(&stored, &current, sizeof(stored)) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+static bool replayConfigSnapshot(FFinstance* instance, FFdata* data, const char* snapshot, uint32_t snapshotSize)
+{
+    uint32_t filesSize;
+    if(snapshotSize < sizeof(filesSize))
+        return false;
+    memcpy(&filesSize, snapshot, sizeof(filesSize));
+
+    const char* files = snapshot + sizeof(filesSize);
+    const char* options = files + filesSize;
+    const char* end = snapshot + snapshotSize;
+    if(filesSize > snapshotSize - sizeof(filesSize) || (options < end && end[-1] != '\0'))
+        return false;
+
+    if(!isConfigSnapshotValid(files, options))
+        return false;
+
+    //Check the structure first, options which add to a list must not be applied twice if the full parse runs after all
+    for(const char* option = options; option < end;)
+    {
+        option += strlen(option) + 1;
+        if(option >= end)
+            return false;
+        if(*option++)
+            option += strlen(option) + 1;
+    }
+
+    while(options < end)
+    {
+        const char* key = options;
+        options += strlen(key) + 1;
+
+        const char* value = NULL;
+        if(*options++)
+        {
+            value = options;
+            options += strlen(value) + 1;
+        }
+
+        parseOption(instance, data, key, value);
+    }
+
+    return true;
+}
+
+static bool loadConfigSnapshot(FFinstance* instance, FFdata* data, const FFstrbuf* key)
+{
+    #ifndef _WIN32
+        uint32_t snapshotSize;
+        const char* snapshot = ffCacheMap(instance, "config", key->length, key->chars, &snapshotSize);
+        return snapshot != NULL && replayConfigSnapshot(instance, data, snapshot, snapshotSize);
+    #else
+        FF_STRBUF_AUTO_DESTROY snapshot;
+        ffStrbufInit(&snapshot);
+        return
+            ffCacheReadStrbuf(instance, "config", key->length, key->chars, &snapshot) &&
+            replayConfigSnapshot(instance, data, snapshot.chars, snapshot.length);
+    #endif
+}
+
+static void writeConfigSnapshot(const FFinstance* instance, const FFConfigSnapshot* snapshot, const FFstrbuf* key)
+{
+    FF_STRBUF_AUTO_DESTROY content;
+    ffStrbufInitA(&content, (uint32_t) sizeof(uint32_t) + snapshot->files.length + snapshot->options.length);
+    ffStrbufAppendNS(&content, sizeof(snapshot->files.length), (const char*) &snapshot->files.length);
+    ffStrbufAppend(&content, &snapshot->files);
+    ffStrbufAppend(&content, &snapshot->options);
+    ffCacheWriteStrbuf(instance, "config", key->length, key->chars, &content);
+}
+
+static void parseConfigs(FFinstance* instance, FFdata* data, int argc, const char** argv)
+{
+    if(getenv("NO_CONFIG"))
+    {
+        parseArguments(instance, data, argc, argv);
+        return;
+    }
+
+    FF_STRBUF_AUTO_DESTROY key;
+    ffStrbufInitA(&key, 256);
+    getConfigSnapshotKey(instance, argc, argv, &key);
+
+    if(loadConfigSnapshot(instance, data, &key))
+        return;
+
+    FFConfigSnapshot snapshot;
+    ffStrbufInit(&snapshot.files);
+    ffStrbufInit(&snapshot.options);
+
+    data->snapshot = &snapshot;
+    parseConfigFiles(instance, data);
+    parseArguments(instance, data, argc, argv);
+    data->snapshot = NULL;
+
+    writeConfigSnapshot(instance, &snapshot, &key);
+
+    ffStrbufDestroy(&snapshot.files);
+    ffStrbufDestroy(&snapshot.options);
+}
+
 static void parseStructureCommand(FFinstance* instance, FFdata* data, const char* line)
 {
     CustomValue* customValue = ffValuestoreGet(&data->customValues, line);
@@ -1399,115 +1543,17 @@ static void parseStructureCommand(FFinstance* instance, FFdata* data, const char
         return;
     }
 
-    if(strcasecmp(line, "break") == 0)
-        ffPrintBreak(instance);
-    else if(strcasecmp(line, "title") == 0)
-        ffPrintTitle(instance);
-    else if(strcasecmp(line, "separator") == 0)
-        ffPrintSeparator(instance);
-    else if(strcasecmp(line, "os") == 0)
-        ffPrintOS(instance);
-    else if(strcasecmp(line, "host") == 0)
-        ffPrintHost(instance);
-    else if(strcasecmp(line, "bios") == 0)
-        ffPrintBios(instance);
-    else if(strcasecmp(line, "board") == 0)
-        ffPrintBoard(instance);
-    else if(strcasecmp(line, "brightness") == 0)
-        ffPrintBrightness(instance);
-    else if(strcasecmp(line, "chassis") == 0)
-        ffPrintChassis(instance);
-    else if(strcasecmp(line, "kernel") == 0)
-        ffPrintKernel(instance);
-    else if(strcasecmp(line, "uptime") == 0)
-        ffPrintUptime(instance);
-    else if(strcasecmp(line, "processes") == 0)
-        ffPrintProcesses(instance);
-    else if(strcasecmp(line, "packages") == 0)
-        ffPrintPackages(instance);
-    else if(strcasecmp(line, "shell") == 0)
-        ffPrintShell(instance);
-    else if(strcasecmp(line, "display") == 0)
-        ffPrintDisplay(instance);
-    else if(strcasecmp(line, "desktopenvironment") == 0 || strcasecmp(line, "de") == 0)
-        ffPrintDesktopEnvironment(instance);
-    else if(strcasecmp(line, "windowmanager") == 0 || strcasecmp(line, "wm") == 0)
-        ffPrintWM(instance);
-    else if(strcasecmp(line, "theme") == 0)
-        ffPrintTheme(instance);
-    else if(strcasecmp(line, "wmtheme") == 0)
-        ffPrintWMTheme(instance);
-    else if(strcasecmp(line, "icons") == 0)
-        ffPrintIcons(instance);
-    else if(strcasecmp(line, "font") == 0)
-        ffPrintFont(instance);
-    else if(strcasecmp(line, "cursor") == 0)
-        ffPrintCursor(instance);
-    else if(strcasecmp(line, "terminal") == 0)
-        ffPrintTerminal(instance);
-    else if(strcasecmp(line, "terminalfont") == 0)
-        ffPrintTerminalFont(instance);
-    else if(strcasecmp(line, "cpu") == 0)
-        ffPrintCPU(instance);
-    else if(strcasecmp(line, "cpuusage") == 0)
-        ffPrintCPUUsage(instance);
-    else if(strcasecmp(line, "gpu") == 0)
-        ffPrintGPU(instance);
-    else if(strcasecmp(line, "memory") == 0)
-        ffPrintMemory(instance);
-    else if(strcasecmp(line, "swap") == 0)
-        ffPrintSwap(instance);
-    else if(strcasecmp(line, "disk") == 0)
-        ffPrintDisk(instance);
-    else if(strcasecmp(line, "battery") == 0)
-        ffPrintBattery(instance);
-    else if(strcasecmp(line, "poweradapter") == 0)
-        ffPrintPowerAdapter(instance);
-    else if(strcasecmp(line, "locale") == 0)
-        ffPrintLocale(instance);
-    else if(strcasecmp(line, "localip") == 0)
-        ffPrintLocalIp(instance);
-    else if(strcasecmp(line, "publicip") == 0)
-        ffPrintPublicIp(instance);
-    else if(strcasecmp(line, "wifi") == 0)
-        ffPrintWifi(instance);
-    else if(strcasecmp(line, "weather") == 0)
-        ffPrintWeather(instance);
-    else if(strcasecmp(line, "player") == 0)
-        ffPrintPlayer(instance);
-    else if(strcasecmp(line, "media") == 0)
-        ffPrintMedia(instance);
-    else if(strcasecmp(line, "datetime") == 0)
-        ffPrintDateTime(instance);
-    else if(strcasecmp(line, "date") == 0)
-        ffPrintDate(instance);
-    else if(strcasecmp(line, "time") == 0)
-        ffPrintTime(instance);
-    else if(strcasecmp(line, "colors") == 0)
-        ffPrintColors(instance);
-    else if(strcasecmp(line, "vulkan") == 0)
-        ffPrintVulkan(instance);
-    else if(strcasecmp(line, "opengl") == 0)
-        ffPrintOpenGL(instance);
-    else if(strcasecmp(line, "opencl") == 0)
-        ffPrintOpenCL(instance);
-    else if(strcasecmp(line, "users") == 0)
-        ffPrintUsers(instance);
-    else if(strcasecmp(line, "command") == 0)
-        ffPrintCommand(instance);
-    else if(strcasecmp(line, "bluetooth") == 0)
-        ffPrintBluetooth(instance);
-    else if(strcasecmp(line, "sound") == 0)
-        ffPrintSound(instance);
-    else if(strcasecmp(line, "gamepad") == 0)
-        ffPrintGamepad(instance);
+    const FFModuleInfo* module = ffModuleFind(line);
+    if(module != NULL)
+        module->print(instance);
     else
         ffPrintErrorString(instance, line, 0, NULL, NULL, "<no implementation provided>");
 }
 
 int main(int argc, const char** argv)
 {
-    FFinstance instance;
+    //Static, because detached detection threads may still read it while the process exits and reuses the stack
+    static FFinstance instance;
     ffInitInstance(&instance);
 
     //Data stores things only needed for the configuration of fastfetch
@@ -1515,25 +1561,38 @@ int main(int argc, const char** argv)
     ffValuestoreInit(&data.customValues, sizeof(CustomValue));
     ffStrbufInitA(&data.structure, 256);
     data.loadUserConfig = true;
+    data.snapshot = NULL;
 
-    if(!getenv("NO_CONFIG"))
-        parseConfigFiles(&instance, &data);
-    parseArguments(&instance, &data, argc, argv);
+    parseConfigs(&instance, &data, argc, argv);
+
+    //Format strings don't change after this point, so they only need to be parsed once, even if a module prints many lines
+    for(uint32_t i = 0; i < ffModulesCount; ++i)
+    {
+        FFModuleArgs* args = ffModuleGetArgs(&instance.config, &ffModules[i]);
+        if(args == NULL)
+            continue;
+
+        if(args->key.length > 0)
+            ffFormatCompile(&args->key);
+        if(args->outputFormat.length > 0)
+            ffFormatCompile(&args->outputFormat);
+        if(args->errorFormat.length > 0)
+            ffFormatCompile(&args->errorFormat);
+    }
 
     //If we don't have a custom structure, use the default one
     if(data.structure.length == 0)
         ffStrbufAppendS(&data.structure, FASTFETCH_DATATEXT_STRUCTURE);
 
-    if(ffStrbufContainIgnCaseS(&data.structure, "CPUUsage"))
-        ffPrepareCPUUsage();
-
-    if(instance.config.multithreading)
+    //Start detections which take time in the background, before the first module is printed
+    for(uint32_t i = 0; i < ffModulesCount; ++i)
     {
-        if(ffStrbufContainIgnCaseS(&data.structure, "PublicIp"))
-            ffPreparePublicIp(&instance);
-
-        if(ffStrbufContainIgnCaseS(&data.structure, "Weather"))
-            ffPrepareWeather(&instance);
+        const FFModuleInfo* module = &ffModules[i];
+        if(
+            module->prepare != NULL &&
+            (instance.config.multithreading || !module->prepareNeedsMultithreading) &&
+            ffStrbufContainIgnCaseS(&data.structure, module->name)
+        ) module->prepare(&instance);
     }
 
     ffStart(&instance);
@@ -1574,8 +1633,14 @@ int main(int argc, const char** argv)
 
     ffFinish(&instance);
 
-    ffStrbufDestroy(&data.structure);
-    ffValuestoreDestroy(&data.customValues);
+    //The process exits anyway, and most of the config lives in the arena. Debug builds free everything, so that leaks can be found
+    #ifndef NDEBUG
+        ffFormatDestroyCompiled();
+        ffStrbufDestroy(&data.structure);
+        for(uint32_t i = 0; i < data.customValues.entries.length; ++i)
+            ffStrbufDestroy(&((CustomValue*) ffHashmapGetValue(&data.customValues, i))->value);
+        ffValuestoreDestroy(&data.customValues);
 
-    ffDestroyInstance(&instance);
+        ffDestroyInstance(&instance);
+    #endif
 }
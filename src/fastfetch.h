@@ -138,6 +138,7 @@ typedef struct FFconfig
     FFModuleArgs memory;
     FFModuleArgs swap;
     FFModuleArgs disk;
+    FFModuleArgs diskIO;
     FFModuleArgs battery;
     FFModuleArgs powerAdapter;
     FFModuleArgs locale;
@@ -183,6 +184,8 @@ typedef struct FFconfig
     FFstrbuf libwlanapi;
     FFstrbuf libnm;
 
+    uint32_t cpuUsageMinInterval;
+
     bool cpuTemp;
     bool gpuTemp;
     bool batteryTemp;
@@ -233,12 +236,24 @@ typedef struct FFconfig
     FFlist commandTexts;
 } FFconfig;
 
+typedef struct FFLogoRow
+{
+    uint32_t start; //Offset in FFstate::logoRows
+    uint32_t prefixLength; //SGR sequences at the start, which restore the colors the previous row ended with
+    uint32_t length; //Including the prefix
+    uint32_t width;
+    bool styledPadding; //The row ends with a background or an attribute which is visible on spaces, so its right padding is printed styled
+} FFLogoRow;
+
 typedef struct FFstate
 {
     uint32_t logoWidth;
     uint32_t logoHeight;
     uint32_t keysHeight;
 
+    FFstrbuf logoRows; //Rows of a text logo, printed by ffLogoPrintLine. Empty if the logo was printed at once
+    FFlist logoRowInfos; //FFLogoRow, one for every line up to logoHeight, indexed by keysHeight
+
     FFPlatform platform;
 } FFstate;
 
@@ -280,6 +295,7 @@ void ffLogoBuiltinListAutocompletion();
 
 void ffPrintDateTimeFormat(FFinstance* instance, const char* moduleName, const FFModuleArgs* moduleArgs);
 void ffPrepareCPUUsage();
+void ffPrepareDiskIO();
 void ffPreparePublicIp(FFinstance* instance);
 void ffPrepareWeather(FFinstance* instance);
 
@@ -316,6 +332,7 @@ void ffPrintGPU(FFinstance* instance);
 void ffPrintMemory(FFinstance* instance);
 void ffPrintSwap(FFinstance* instance); //Also in modules/memory.c
 void ffPrintDisk(FFinstance* instance);
+void ffPrintDiskIO(FFinstance* instance);
 void ffPrintBattery(FFinstance* instance);
 void ffPrintPowerAdapter(FFinstance* instance);
 void ffPrintLocale(FFinstance* instance);
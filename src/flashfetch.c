@@ -5,12 +5,14 @@ int main(int argc, char** argv)
     //Disable compiler warnings
     FF_UNUSED(argc, argv);
 
-    FFinstance instance;
+    //Static, because detached detection threads may still read it while the process exits and reuses the stack
+    static FFinstance instance;
     ffInitInstance(&instance); //This also applys default configuration to instance.config
 
     //Modify instance.config here
 
     // ffPrepareCPUUsage();
+    // ffPrepareDiskIO();
     // ffPreparePublicIp(&instance);
     // ffPrepareWeather(&instance);
 
@@ -46,6 +48,7 @@ int main(int argc, char** argv)
     ffPrintMemory(&instance);
     //ffPrintSwap(&instance);
     ffPrintDisk(&instance);
+    //ffPrintDiskIO(&instance);
     ffPrintBattery(&instance);
     ffPrintPowerAdapter(&instance);
     //ffPrintPlayer(&instance);
@@ -1,5 +1,8 @@
 #include "logo.h"
 
+#include <ctype.h>
+#include <strings.h>
+
 #define FF_LOGO_INIT static FFlogo logo; static bool init = false; if(init) return &logo; init = true;
 #define FF_LOGO_NAMES(...) static const char* names[] = (const char*[]) { __VA_ARGS__, NULL }; logo.names = names;
 #define FF_LOGO_LINES(x) logo.data = x;
@@ -2426,92 +2429,180 @@ static const FFlogo* getLogoZorin()
     FF_LOGO_RETURN
 }
 
+static GetLogoMethod logoMethods[] = {
+    ffLogoBuiltinGetUnknown,
+    getLogoAlmaLinux,
+    getLogoAlpine,
+    getLogoAlpineSmall,
+    getLogoAndroid,
+    getLogoAndroidSmall,
+    getLogoArch,
+    getLogoArchSmall,
+    getLogoArcoLinux,
+    getLogoArtix,
+    getLogoArtixSmall,
+    getLogoBedrock,
+    getLogoCachyOS,
+    getLogoCachyOSSmall,
+    getLogoCelOS,
+    getLogoCentOS,
+    getLogoCentOSSmall,
+    getLogoCRUX,
+    getLogoCrystalLinux,
+    getLogoDebian,
+    getLogoDevuan,
+    getLogoDevuanSmall,
+    getLogoDebianSmall,
+    getLogoDeepin,
+    getLogoEndeavour,
+    getLogoEnso,
+    getLogoFedora,
+    getLogoFedoraSmall,
+    getLogoFedoraOld,
+    getLogoFreeBSD,
+    getLogoGaruda,
+    getLogoGarudaSmall,
+    getLogoGentoo,
+    getLogoGentooSmall,
+    getLogoKDENeon,
+    getLogoKISSLinux,
+    getLogoKubuntu,
+    getLogoLangitKetujuh,
+    getLogoLinux,
+    getLogoMacOS,
+    getLogoManjaro,
+    getLogoManjaroSmall,
+    getLogoMint,
+    getLogoMintSmall,
+    getLogoMintOld,
+    getLogoMsys2,
+    getLogoWindows11,
+    getLogoWindows11Small,
+    getLogoWindows8,
+    getLogoWindows,
+    getLogoNixOS,
+    getLogoNixOsOld,
+    getLogoNixOsSmall,
+    getLogoNobara,
+    getLogoOpenSuse,
+    getLogoOpenSuseSmall,
+    getLogoOpenSuseLeap,
+    getLogoOpenSuseTumbleweed,
+    getLogoOpenMandriva,
+    getLogoPop,
+    getLogoPopSmall,
+    getLogoParabola,
+    getLogoParabolaSmall,
+    getLogoRaspbian,
+    getLogoRaspbianSmall,
+    getLogoReborn,
+    getLogoRebornSmall,
+    getLogoRedHatEnterpriseLinux,
+    getLogoRedstarOS,
+    getLogoRockyLinux,
+    getLogoRosaLinux,
+    getLogoSlackware,
+    getLogoSlackwareSmall,
+    getLogoSolus,
+    getLogoUbuntu,
+    getLogoUbuntuOld,
+    getLogoUbuntuSmall,
+    getLogoVanilla,
+    getLogoVoid,
+    getLogoVoidSmall,
+    getLogoZorin,
+    NULL
+};
+
 GetLogoMethod* ffLogoBuiltinGetAll()
 {
-    static GetLogoMethod logoMethods[] = {
-        ffLogoBuiltinGetUnknown,
-        getLogoAlmaLinux,
-        getLogoAlpine,
-        getLogoAlpineSmall,
-        getLogoAndroid,
-        getLogoAndroidSmall,
-        getLogoArch,
-        getLogoArchSmall,
-        getLogoArcoLinux,
-        getLogoArtix,
-        getLogoArtixSmall,
-        getLogoBedrock,
-        getLogoCachyOS,
-        getLogoCachyOSSmall,
-        getLogoCelOS,
-        getLogoCentOS,
-        getLogoCentOSSmall,
-        getLogoCRUX,
-        getLogoCrystalLinux,
-        getLogoDebian,
-        getLogoDevuan,
-        getLogoDevuanSmall,
-        getLogoDebianSmall,
-        getLogoDeepin,
-        getLogoEndeavour,
-        getLogoEnso,
-        getLogoFedora,
-        getLogoFedoraSmall,
-        getLogoFedoraOld,
-        getLogoFreeBSD,
-        getLogoGaruda,
-        getLogoGarudaSmall,
-        getLogoGentoo,
-        getLogoGentooSmall,
-        getLogoKDENeon,
-        getLogoKISSLinux,
-        getLogoKubuntu,
-        getLogoLangitKetujuh,
-        getLogoLinux,
-        getLogoMacOS,
-        getLogoManjaro,
-        getLogoManjaroSmall,
-        getLogoMint,
-        getLogoMintSmall,
-        getLogoMintOld,
-        getLogoMsys2,
-        getLogoWindows11,
-        getLogoWindows11Small,
-        getLogoWindows8,
-        getLogoWindows,
-        getLogoNixOS,
-        getLogoNixOsOld,
-        getLogoNixOsSmall,
-        getLogoNobara,
-        getLogoOpenSuse,
-        getLogoOpenSuseSmall,
-        getLogoOpenSuseLeap,
-        getLogoOpenSuseTumbleweed,
-        getLogoOpenMandriva,
-        getLogoPop,
-        getLogoPopSmall,
-        getLogoParabola,
-        getLogoParabolaSmall,
-        getLogoRaspbian,
-        getLogoRaspbianSmall,
-        getLogoReborn,
-        getLogoRebornSmall,
-        getLogoRedHatEnterpriseLinux,
-        getLogoRedstarOS,
-        getLogoRockyLinux,
-        getLogoRosaLinux,
-        getLogoSlackware,
-        getLogoSlackwareSmall,
-        getLogoSolus,
-        getLogoUbuntu,
-        getLogoUbuntuOld,
-        getLogoUbuntuSmall,
-        getLogoVanilla,
-        getLogoVoid,
-        getLogoVoidSmall,
-        getLogoZorin,
-        NULL
-    };
-
     return logoMethods;
 }
+
+uint32_t ffLogoBuiltinHash(const char* name)
+{
+    // FNV-1a of the lower case name
+    uint32_t hash = 0x811C9DC5u;
+    for(; *name != '\0'; ++name)
+    {
+        hash ^= (uint8_t) tolower((unsigned char) *name);
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+uint32_t ffLogoBuiltinSlot(uint32_t hash, uint8_t displacement)
+{
+    // Finalizer of MurmurHash3, so that every displacement gives a different spread
+    hash ^= displacement * 0x9E3779B9u;
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    return hash & (FF_LOGO_HASH_SIZE - 1);
+}
+
+// Generated from all names of logoMethods. If a logo or name is added, `fastfetch-test-logo` prints the new tables
+static const uint8_t logoDisplacements[FF_LOGO_BUCKET_COUNT] = {
+      1,  0,  1,  0,  0,  0,  0,  6,  0,  0,  0,  0,  0,  1,  0,  0,
+      3,  3,  0,  0,  0,  0,  2,  0,  0,  0,  0,  0,  0,  1,  0,  0,
+      0,  1,  1,  0,  0,  1,  0,  1,  1,  0,  0,  0,  1,  1,  2,  0,
+      1,  1,  0,  1,  0,  0,  0,  0,  0,  0,  0,  1,  4,  0,  2,  0,
+      0,  1,  0,  0,  1,  0,  5,  0,  0,  3,  3,  1,  1,  1,  6,  0,
+      0,  1,  2,  0,  1,  0,  0,  0,  6,  1,  0,  0,  2,  1,  0,  0,
+      0,  0,  1,  2,  1,  0,  0,  0,  0,  0,  1,  1,  0,  0,  0,  0,
+      0,  0,  0,  5,  0,  0,  0,  1,  0,  1,  0,  2,  0,  3,  0,  0,
+};
+
+// Index + 1 into logoMethods, 0 if the slot is empty
+static const uint8_t logoSlots[FF_LOGO_HASH_SIZE] = {
+     70, 66,  0, 38, 29,  0,  0,  0,  0,  0, 12,  0, 31,  0,  0,  0,
+      0,  0,  8,  0, 39,  0,  0,  0, 59, 14, 58,  0,  0,  0,  0,  0,
+     55, 32, 73,  0,  0,  0,  0, 50,  0,  0,  0,  0, 13,  0,  0,  0,
+      0,  0,  0,  0,  0, 43, 66, 35,  0,  9,  0,  0,  0, 49, 15,  0,
+      0,  0, 49,  0,  0,  0, 55, 29,  0,  9,  0, 23, 25,  0, 75, 47,
+      0, 43,  0, 33,  0,  0,  0,  7, 35, 37,  0,  0,  0,  0, 45,  0,
+     72,  0,  0,  0, 37, 49,  0,  0, 17,  0, 57, 67,  0,  0, 55,  0,
+      0, 40, 27, 60,  0,  0,  0, 57, 80, 66, 23, 58,  0, 57,  1,  0,
+     14, 15,  0,  0,  0, 51,  0,  0, 42, 76,  0, 52,  0,  0, 81,  0,
+     72, 70, 25, 64, 52,  7,  0, 54,  0,  6, 53, 58, 74,  0,  0,  0,
+     28, 55,  0, 77, 76,  1, 31, 53,  3, 61,  0,  0,  0, 44, 13,  0,
+      0, 17,  0, 56,  6,  0,  0, 30,  0, 51, 11,  0, 15, 66,  0,  0,
+      0, 72, 45,  0,  0,  3,  0, 12,  0, 32, 29,  0, 48,  0, 68, 63,
+     51,  0,  0,  0,  0, 13,  0,  0,  0, 27,  8,  0,  0, 40, 40,  0,
+      0,  0, 81, 38, 16,  0,  0, 32, 49, 10,  0, 60, 59,  0, 57,  0,
+     65,  4,  0, 69,  5,  0, 24, 77, 26,  0, 36,  0, 65,  0, 53,  0,
+     36, 58, 44,  0,  0,  0,  0,  0,  0, 17, 47,  0, 68, 71, 69, 34,
+     40, 10,  0, 40,  0, 51, 20,  0,  0,  0,  0,  0, 57,  0, 45,  0,
+     15,  0, 22,  0,  0,  0,  0,  0,  0,  0,  0,  0, 67, 16,  0,  0,
+      0,  0, 55, 49,  1,  0, 42,  0,  0, 17, 44,  0,  0,  0, 58, 43,
+     11,  0, 73,  0, 45,  0,  0, 61, 11,  0,  0, 58, 73,  0, 52, 20,
+      0, 19,  0, 41, 25, 49,  0, 60,  0,  0,  0, 21,  0,  9,  0, 73,
+     80, 16, 74,  0, 57,  0, 71,  0, 37,  0,  0,  0,  0,  0,  8,  0,
+      0,  0,  0,  0, 17,  0, 67,  0,  0, 18,  0, 24,  3,  0, 69, 64,
+      0, 70, 35, 12, 13, 19,  0, 78, 34, 48,  0, 63, 10,  0,  0,  0,
+      0, 25, 57, 69, 26, 45, 59, 21,  0, 66, 50, 81, 79, 52, 60,  4,
+     52, 71,  0,  0, 64, 58,  0,  0, 50,  0,  0,  0, 52,  7, 29,  0,
+      0,  0, 28, 62, 39,  0, 54, 67, 14, 36,  0,  0, 68, 62,  0,  0,
+      0,  0, 78,  0, 67,  0, 46,  0, 53,  0,  0, 22,  0, 51,  0,  0,
+     53, 51, 78, 14, 51, 37,  0, 56, 75,  0, 16, 56,  0,  0,  0,  0,
+      0,  0,  0, 41, 50, 33,  0, 79, 65,  0,  0,  0, 61,  0,  0,  2,
+      0, 37, 45, 61, 69,  0, 49,  0, 43, 81, 56, 53,  0,  0,  0,  0,
+};
+
+const FFlogo* ffLogoBuiltinFind(const char* name)
+{
+    uint32_t hash = ffLogoBuiltinHash(name);
+    uint8_t slot = logoSlots[ffLogoBuiltinSlot(hash, logoDisplacements[hash >> (32 - FF_LOGO_BUCKET_BITS)])];
+    if(slot == 0)
+        return NULL;
+
+    // A different name can hash into the same slot, so verify it
+    const FFlogo* logo = logoMethods[slot - 1]();
+    for(const char** logoName = logo->names; *logoName != NULL; ++logoName)
+    {
+        if(strcasecmp(*logoName, name) == 0)
+            return logo;
+    }
+
+    return NULL;
+}
@@ -99,9 +99,16 @@ static bool printImageKittyDirect(FFinstance* instance)
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 
 #ifndef _WIN32
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #else
 #include <wincon.h>
 
@@ -190,7 +197,23 @@ static void writeCacheStrbuf(FFLogoRequestData* requestData, const FFstrbuf* val
 {
     uint32_t cacheDirLength = requestData->cacheDir.length;
     ffStrbufAppendS(&requestData->cacheDir, cacheFileName);
-    ffWriteFileBuffer(requestData->cacheDir.chars, value);
+
+    // Write to a temporary file of this instance first, so concurrent instances never see or write into a partially written cache file
+    FF_STRBUF_AUTO_DESTROY tmpPath;
+    ffStrbufInitCopy(&tmpPath, &requestData->cacheDir);
+    ffStrbufAppendC(&tmpPath, '.');
+    ffStrbufAppendUInt(&tmpPath, (uint64_t) getpid());
+    ffStrbufAppendS(&tmpPath, ".tmp");
+    if(!ffWriteFileBuffer(tmpPath.chars, value))
+        remove(tmpPath.chars);
+    else if(rename(tmpPath.chars, requestData->cacheDir.chars) != 0)
+    {
+        // Windows doesn't replace existing files
+        remove(requestData->cacheDir.chars);
+        if(rename(tmpPath.chars, requestData->cacheDir.chars) != 0)
+            remove(tmpPath.chars);
+    }
+
     ffStrbufSubstrBefore(&requestData->cacheDir, cacheDirLength);
 }
 
@@ -568,6 +591,51 @@ static bool printCachedChars(FFinstance* instance, FFLogoRequestData* requestDat
     return true;
 }
 
+//Cached pixel data can be hundreds of kilobytes. It is passed to stdout without copying it through a buffer where possible
+static void writeCachedFD(int fd)
+{
+    #ifndef _WIN32
+
+    struct stat fileInfo;
+    if(fstat(fd, &fileInfo) == 0 && fileInfo.st_size > 0)
+    {
+        size_t size = (size_t) fileInfo.st_size;
+        size_t written = 0;
+
+        #ifdef __linux__
+            //Works for every kind of stdout since Linux 2.6.33. Fails with EINVAL if it doesn't, nothing is written then
+            off_t offset = 0;
+            ssize_t sent;
+            while(written < size && (sent = sendfile(STDOUT_FILENO, fd, &offset, size - written)) > 0)
+                written += (size_t) sent;
+        #endif
+
+        if(written == size)
+            return;
+
+        uint8_t* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data != MAP_FAILED)
+        {
+            ssize_t result;
+            while(written < size && (result = write(STDOUT_FILENO, data + written, size - written)) > 0)
+                written += (size_t) result;
+
+            munmap(data, size);
+            return;
+        }
+
+        if(lseek(fd, (off_t) written, SEEK_SET) != (off_t) written)
+            return;
+    }
+
+    #endif
+
+    char buffer[32768];
+    ssize_t readBytes;
+    while((readBytes = ffReadFDData(FFUnixFD2NativeFD(fd), sizeof(buffer), buffer)) > 0)
+        ffWriteFDData(FFUnixFD2NativeFD(STDOUT_FILENO), (size_t) readBytes, buffer);
+}
+
 static bool printCachedPixel(FFinstance* instance, FFLogoRequestData* requestData)
 {
     requestData->logoCharacterWidth = instance->config.logo.width;
@@ -603,11 +671,7 @@ static bool printCachedPixel(FFinstance* instance, FFLogoRequestData* requestDat
     ffPrintCharTimes(' ', instance->config.logo.paddingLeft);
     fflush(stdout);
 
-    char buffer[32768];
-    ssize_t readBytes;
-    while((readBytes = ffReadFDData(FFUnixFD2NativeFD(fd), sizeof(buffer), buffer)) > 0)
-        ffWriteFDData(FFUnixFD2NativeFD(STDOUT_FILENO), (size_t) readBytes, buffer);
-
+    writeCachedFD(fd);
     close(fd);
 
     instance->state.logoWidth = requestData->logoCharacterWidth + instance->config.logo.paddingLeft + instance->config.logo.paddingRight;
@@ -664,6 +728,59 @@ static bool getCharacterPixelDimensions(FFLogoRequestData* requestData)
     return requestData->characterPixelWidth > 1.0 && requestData->characterPixelHeight > 1.0;
 }
 
+static inline uint64_t hashData(uint64_t hash, const void* data, size_t length)
+{
+    //FNV-1a
+    for(size_t i = 0; i < length; ++i)
+        hash = (hash ^ ((const uint8_t*) data)[i]) * 0x100000001b3u;
+    return hash;
+}
+
+#define FF_CACHE_KEY_HASH(hash, value) hash = hashData(hash, &(value), sizeof(value))
+
+//The cache entries of an image source live in a directory named after everything the output depends on:
+//the file as far as stat tells (so a replaced or modified file gets new entries instead of stale ones) and the encoder settings
+static bool appendCacheKey(const FFinstance* instance, FFLogoRequestData* requestData)
+{
+    struct stat fileInfo;
+    if(stat(instance->config.logo.source.chars, &fileInfo) != 0)
+        return false;
+
+    uint64_t mtime = (uint64_t) fileInfo.st_mtime * 1000000000u;
+    #if defined(__APPLE__)
+        mtime += (uint64_t) fileInfo.st_mtimespec.tv_nsec;
+    #elif !defined(_WIN32)
+        mtime += (uint64_t) fileInfo.st_mtim.tv_nsec;
+    #endif
+    uint64_t size = (uint64_t) fileInfo.st_size;
+    uint64_t inode = (uint64_t) fileInfo.st_ino;
+    uint64_t device = (uint64_t) fileInfo.st_dev;
+
+    uint64_t hash = 0xcbf29ce484222325u;
+    FF_CACHE_KEY_HASH(hash, mtime);
+    FF_CACHE_KEY_HASH(hash, size);
+    FF_CACHE_KEY_HASH(hash, inode);
+    FF_CACHE_KEY_HASH(hash, device);
+
+    FF_CACHE_KEY_HASH(hash, requestData->type);
+    FF_CACHE_KEY_HASH(hash, requestData->logoPixelWidth);
+    FF_CACHE_KEY_HASH(hash, requestData->logoPixelHeight);
+    FF_CACHE_KEY_HASH(hash, requestData->characterPixelWidth);
+    FF_CACHE_KEY_HASH(hash, requestData->characterPixelHeight);
+
+    if(requestData->type == FF_LOGO_TYPE_IMAGE_CHAFA)
+    {
+        FF_CACHE_KEY_HASH(hash, instance->config.logo.chafaFgOnly);
+        FF_CACHE_KEY_HASH(hash, instance->config.logo.chafaCanvasMode);
+        FF_CACHE_KEY_HASH(hash, instance->config.logo.chafaColorSpace);
+        FF_CACHE_KEY_HASH(hash, instance->config.logo.chafaDitherMode);
+        hash = hashData(hash, instance->config.logo.chafaSymbols.chars, instance->config.logo.chafaSymbols.length + 1);
+    }
+
+    ffStrbufAppendF(&requestData->cacheDir, "%016" PRIx64 "/", hash);
+    return true;
+}
+
 static bool printImageIfExistsSlowPath(FFinstance* instance, FFLogoType type, bool printError)
 {
     FFLogoRequestData requestData;
@@ -699,10 +816,13 @@ static bool printImageIfExistsSlowPath(FFinstance* instance, FFLogoType type, bo
     ffStrbufRecalculateLength(&requestData.cacheDir);
     ffStrbufEnsureEndsWithC(&requestData.cacheDir, '/');
 
-    ffStrbufAppendF(&requestData.cacheDir, "%u", requestData.logoPixelWidth);
-    ffStrbufAppendC(&requestData.cacheDir, '*');
-    ffStrbufAppendF(&requestData.cacheDir, "%u", requestData.logoPixelHeight);
-    ffStrbufAppendC(&requestData.cacheDir, '/');
+    if(!appendCacheKey(instance, &requestData))
+    {
+        ffStrbufDestroy(&requestData.cacheDir);
+        if(printError)
+            fputs("Logo: Querying file info of the image source failed", stderr);
+        return false;
+    }
 
     if(!instance->config.recache && printCached(instance, &requestData))
     {
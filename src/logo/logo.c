@@ -19,35 +19,247 @@ static void ffLogoPrintCharsRaw(FFinstance* instance, const char* data, size_t l
     printf("\033[9999999D\n\033[%uA", instance->state.logoHeight);
 }
 
+static void appendCharTimes(FFstrbuf* buffer, char c, uint32_t times)
+{
+    if(times == 0)
+        return;
+
+    ffStrbufEnsureFree(buffer, times);
+    memset(buffer->chars + buffer->length, c, times);
+    buffer->length += times;
+    buffer->chars[buffer->length] = '\0';
+}
+
+static void appendColor(FFstrbuf* buffer, const FFstrbuf* color)
+{
+    //Same as ffPrintColor, an empty color would reset everything
+    if(color->length == 0)
+        return;
+
+    ffStrbufAppendS(buffer, "\033[");
+    ffStrbufAppend(buffer, color);
+    ffStrbufAppendC(buffer, 'm');
+}
+
+// Display width of plain text: one column per UTF-8 character, so continuation bytes are not counted
+static uint32_t textWidth(const char* text, size_t length)
+{
+    uint32_t width = 0;
+    for(size_t i = 0; i < length; ++i)
+        width += ((unsigned char) text[i] & 0xC0) != 0x80;
+    return width;
+}
+
+// The SGR state in effect, so that a composed row can start with the attributes and colors the previous one ended with.
+// Like in a terminal, every attribute and both colors have their own slot, which only their own codes change and 0 clears
+typedef struct LogoStyle
+{
+    uint32_t attributes; // Bit N is set if SGR N (1 bold - 9 strikethrough) is in effect
+    char foreground[24]; // Parameters of the foreground color, e.g. "31", "38;5;200" or "38;2;255;128;0"
+    char background[24];
+} LogoStyle;
+
+static uint32_t readStyleParam(const char** params, const char* end)
+{
+    uint32_t value = 0;
+    for(; *params < end && **params != ';'; ++*params)
+        value = value * 10 + (uint32_t) (**params - '0');
+    return value;
+}
+
+static void setStyleColor(char* color, const char* start, const char* end)
+{
+    size_t length = (size_t) (end - start);
+    if(length >= sizeof(((LogoStyle*) NULL)->foreground))
+        return;
+    memcpy(color, start, length);
+    color[length] = '\0';
+}
+
+static void updateStyle(LogoStyle* style, const char* params, uint32_t length)
+{
+    const char* end = params + length;
+    while(true)
+    {
+        const char* start = params;
+        uint32_t code = readStyleParam(&params, end);
+
+        if(code == 0)
+        {
+            style->attributes = 0;
+            style->foreground[0] = '\0';
+            style->background[0] = '\0';
+        }
+        else if(code <= 9)
+            style->attributes |= 1u << code;
+        else if(code == 22)
+            style->attributes &= ~((1u << 1) | (1u << 2)); // Neither bold nor faint
+        else if(code == 25)
+            style->attributes &= ~((1u << 5) | (1u << 6)); // Neither slow nor rapid blink
+        else if(code >= 23 && code <= 29)
+            style->attributes &= ~(1u << (code - 20));
+        else if((code >= 30 && code <= 37) || (code >= 90 && code <= 97))
+            setStyleColor(style->foreground, start, params);
+        else if((code >= 40 && code <= 47) || (code >= 100 && code <= 107))
+            setStyleColor(style->background, start, params);
+        else if(code == 39)
+            style->foreground[0] = '\0';
+        else if(code == 49)
+            style->background[0] = '\0';
+        else if(code == 38 || code == 48)
+        {
+            //38;5;N or 38;2;R;G;B
+            uint32_t arguments = 0;
+            if(params < end)
+            {
+                ++params;
+                uint32_t mode = readStyleParam(&params, end);
+                arguments = mode == 5 ? 1 : mode == 2 ? 3 : 0;
+            }
+            for(uint32_t i = 0; i < arguments && params < end; ++i)
+            {
+                ++params;
+                readStyleParam(&params, end);
+            }
+            setStyleColor(code == 38 ? style->foreground : style->background, start, params);
+        }
+
+        if(params >= end)
+            break;
+        ++params; // ;
+    }
+}
+
+// Appends the style as one sequence, e.g. "\033[1;37;44m", or nothing for the default style
+static void appendStyle(FFstrbuf* buffer, const LogoStyle* style)
+{
+    uint32_t start = buffer->length;
+    ffStrbufAppendS(buffer, "\033[");
+
+    for(uint32_t i = 1; i <= 9; ++i)
+    {
+        if(!(style->attributes & (1u << i)))
+            continue;
+        if(buffer->length > start + 2)
+            ffStrbufAppendC(buffer, ';');
+        ffStrbufAppendUInt(buffer, i);
+    }
+
+    const char* colors[] = { style->foreground, style->background };
+    for(uint32_t i = 0; i < sizeof(colors) / sizeof(colors[0]); ++i)
+    {
+        if(colors[i][0] == '\0')
+            continue;
+        if(buffer->length > start + 2)
+            ffStrbufAppendC(buffer, ';');
+        ffStrbufAppendS(buffer, colors[i]);
+    }
+
+    if(buffer->length == start + 2)
+        ffStrbufSubstrBefore(buffer, start);
+    else
+        ffStrbufAppendC(buffer, 'm');
+}
+
+// A composed row starts with the style in effect, which ffLogoPrintRemaining skips if the previous row was printed right before
+static void startRow(FFinstance* instance, const LogoStyle* style)
+{
+    FFLogoRow* row = ffListAdd(&instance->state.logoRowInfos);
+    row->start = instance->state.logoRows.length;
+    appendStyle(&instance->state.logoRows, style);
+    row->prefixLength = instance->state.logoRows.length - row->start;
+}
+
+static void endRow(FFinstance* instance, const LogoStyle* style, uint32_t width)
+{
+    FFLogoRow* row = ffListGet(&instance->state.logoRowInfos, instance->state.logoRowInfos.length - 1);
+    row->length = instance->state.logoRows.length - row->start;
+    row->width = width;
+    row->styledPadding = style->background[0] != '\0' || (style->attributes & ((1u << 4) | (1u << 7) | (1u << 9))); // Underline, inverse, strikethrough
+}
+
 void ffLogoPrintChars(FFinstance* instance, const char* data, bool doColorReplacement)
 {
-    uint32_t currentlineLength = 0;
+    //The logo is copied span by span into one buffer. Runs of plain text are found with strcspn,
+    //only the bytes which need handling ($N colors, escape sequences, tabs and line ends) are looked at one by one
+    const char* specialChars = doColorReplacement ? "\n\r\t\033$" : "\n\r\t\033";
 
-    fputs(FASTFETCH_TEXT_MODIFIER_BOLT, stdout);
-    ffPrintCharTimes('\n', instance->config.logo.paddingTop);
-    ffPrintCharTimes(' ', instance->config.logo.paddingLeft);
+    //If the remaining logo is printed after the modules (the default), the logo is not printed here.
+    //It is split into rows instead, each one starting with the colors in effect, which ffLogoPrintLine prints
+    //in front of the module output. Otherwise the logo is printed at once, and the cursor is moved back to its top left corner
+    bool compose = instance->config.logo.printRemaining;
+
+    FF_STRBUF_AUTO_DESTROY buffer;
+    ffStrbufInit(&buffer);
+
+    FFstrbuf* out = &buffer;
+    if(compose)
+    {
+        out = &instance->state.logoRows;
+        ffStrbufClear(out);
+        instance->state.logoRowInfos.length = 0;
+    }
+    else
+        ffStrbufEnsureFree(out, 4096);
+
+    LogoStyle style = { .attributes = 1u << 1 }; // Bold
+
+    uint32_t currentlineLength = 0;
 
     instance->state.logoHeight = instance->config.logo.paddingTop;
+    instance->state.logoWidth = 0;
 
     //Use logoColor[0] as the default color
-    if(doColorReplacement)
-        ffPrintColor(&instance->config.logo.colors[0]);
+    if(doColorReplacement && instance->config.logo.colors[0].length > 0)
+        updateStyle(&style, instance->config.logo.colors[0].chars, instance->config.logo.colors[0].length);
+
+    if(compose)
+    {
+        for(uint32_t i = 0; i < instance->config.logo.paddingTop; ++i)
+            *(FFLogoRow*) ffListAdd(&instance->state.logoRowInfos) = (FFLogoRow) { .start = out->length };
+        startRow(instance, &style);
+    }
+    else
+    {
+        ffStrbufAppendS(out, FASTFETCH_TEXT_MODIFIER_BOLT);
+        appendCharTimes(out, '\n', instance->config.logo.paddingTop);
+        appendCharTimes(out, ' ', instance->config.logo.paddingLeft);
+        if(doColorReplacement)
+            appendColor(out, &instance->config.logo.colors[0]);
+    }
 
     while(*data != '\0')
     {
+        size_t spanLength = strcspn(data, specialChars);
+        if(spanLength > 0)
+        {
+            ffStrbufAppendNS(out, (uint32_t) spanLength, data);
+            currentlineLength += textWidth(data, spanLength);
+            data += spanLength;
+            continue;
+        }
+
         //We are at the end of a line. Print paddings and update max line length
         if(*data == '\n' || (*data == '\r' && *(data + 1) == '\n'))
         {
-            ffPrintCharTimes(' ', instance->config.logo.paddingRight);
+            if(compose)
+            {
+                endRow(instance, &style, currentlineLength);
+                startRow(instance, &style);
+            }
+            else
+                appendCharTimes(out, ' ', instance->config.logo.paddingRight);
 
             //We have \r\n, skip the \r
             if(*data == '\r')
                 ++data;
-
-            putchar('\n');
             ++data;
 
-            ffPrintCharTimes(' ', instance->config.logo.paddingLeft);
+            if(!compose)
+            {
+                ffStrbufAppendC(out, '\n');
+                appendCharTimes(out, ' ', instance->config.logo.paddingLeft);
+            }
 
             if(currentlineLength > instance->state.logoWidth)
                 instance->state.logoWidth = currentlineLength;
@@ -60,7 +272,8 @@ void ffLogoPrintChars(FFinstance* instance, const char* data, bool doColorReplac
         //Always print tabs as 4 spaces, to have consistent spacing
         if(*data == '\t')
         {
-            ffPrintCharTimes(' ', 4);
+            appendCharTimes(out, ' ', 4);
+            currentlineLength += 4;
             ++data;
             continue;
         }
@@ -69,100 +282,82 @@ void ffLogoPrintChars(FFinstance* instance, const char* data, bool doColorReplac
         if(*data == '\033' && *(data + 1) == '[')
         {
             const char* start = data;
-
-            fputs("\033[", stdout);
             data += 2;
 
             while(isdigit(*data) || *data == ';')
-                putchar(*data++); // number
+                ++data; // number
 
             //We have a valid control sequence, print it and continue with next char
-            if(isascii(*data))
+            if(*data != '\0' && isascii(*data))
             {
-                putchar(*data++); // single letter, end of control sequence
+                ++data; // single letter, end of control sequence
+                ffStrbufAppendNS(out, (uint32_t) (data - start), start);
+                if(compose && data[-1] == 'm')
+                    updateStyle(&style, start + 2, (uint32_t) (data - start - 3));
                 continue;
             }
 
             //Invalid control sequence, try to get most accurate length
+            ffStrbufAppendNS(out, (uint32_t) (data - start), start);
             currentlineLength += (uint32_t) (data - start - 1); //-1 for \033 which for sure doesn't take any space
-
-            //Don't continue here, print the char after the letters with the unicode printing
+            continue;
         }
 
         //We have a fastfetch color placeholder. Replace it with the esacape sequence, don't increase the line length
-        if(doColorReplacement && *data == '$')
+        if(*data == '$')
         {
             ++data;
 
-            //If we have $$, or $\0, print it as single $
-            if(*data == '$' || *data == '\0')
-            {
-                putchar('$');
-                ++currentlineLength;
-                ++data;
-                continue;
-            }
-
             //Map the number to an array index, so that '1' -> 0, '2' -> 1, etc.
             int index = ((int) *data) - 49;
 
-            //If the index is valid, print the color. Otherwise continue as normal
-            if(index < 0 || index >= FASTFETCH_LOGO_MAX_COLORS)
-            {
-                putchar('$');
-                ++currentlineLength;
-                //Don't continue here, we want to print the current char as unicode
-            }
-            else
+            if(index >= 0 && index < FASTFETCH_LOGO_MAX_COLORS)
             {
-                ffPrintColor(&instance->config.logo.colors[index]);
+                appendColor(out, &instance->config.logo.colors[index]);
+                if(compose && instance->config.logo.colors[index].length > 0)
+                    updateStyle(&style, instance->config.logo.colors[index].chars, instance->config.logo.colors[index].length);
                 ++data;
                 continue;
             }
-        }
-
-        //Do the printing, respecting unicode
-
-        ++currentlineLength;
 
-        int codepoint = (unsigned char) *data;
-        uint8_t bytes;
-
-        if(codepoint <= 127)
-            bytes = 1;
-        else if((codepoint & 0xE0) == 0xC0)
-            bytes = 2;
-        else if((codepoint & 0xF0) == 0xE0)
-            bytes = 3;
-        else if((codepoint & 0xF8) == 0xF0)
-            bytes = 4;
+            //If we have $$, print it as single $. Otherwise continue as normal
+            if(*data == '$')
+                ++data;
+        }
         else
-            bytes = 1; //Invalid utf8, print it as is, byte by byte
+            ++data; // \r or \033 as normal chars
 
-        for(uint8_t i = 0; i < bytes; ++i)
-        {
-            if(*data == '\0')
-                break;
-
-            putchar(*data++);
-        }
+        ffStrbufAppendC(out, data[-1]);
+        ++currentlineLength;
     }
 
-    ffPrintCharTimes(' ', instance->config.logo.paddingRight);
-    fputs(FASTFETCH_TEXT_MODIFIER_RESET, stdout);
-
     //Happens if the last line is the longest
     if(currentlineLength > instance->state.logoWidth)
         instance->state.logoWidth = currentlineLength;
 
     instance->state.logoWidth += instance->config.logo.paddingLeft + instance->config.logo.paddingRight;
 
+    if(compose)
+    {
+        endRow(instance, &style, currentlineLength);
+        return;
+    }
+
+    appendCharTimes(out, ' ', instance->config.logo.paddingRight);
+    ffStrbufAppendS(out, FASTFETCH_TEXT_MODIFIER_RESET);
+
     //Go to the leftmost position
-    fputs("\033[9999999D", stdout);
+    ffStrbufAppendS(out, "\033[9999999D");
 
     //If the logo height is > 1, go up the height
     if(instance->state.logoHeight > 0)
-        printf("\033[%uA", instance->state.logoHeight);
+    {
+        ffStrbufAppendS(out, "\033[");
+        ffStrbufAppendUInt(out, instance->state.logoHeight);
+        ffStrbufAppendC(out, 'A');
+    }
+
+    ffStrbufWriteTo(&buffer, stdout);
 }
 
 static void logoApplyColors(FFinstance* instance, const FFlogo* logo)
@@ -174,58 +369,27 @@ static void logoApplyColors(FFinstance* instance, const FFlogo* logo)
         ffStrbufAppendS(&instance->config.colorTitle, logo->colorTitle);
 }
 
-static bool logoHasName(const FFlogo* logo, const char* name)
-{
-    const char** logoName = logo->names;
-
-    while(*logoName != NULL)
-    {
-        if(strcasecmp(*logoName, name) == 0)
-            return true;
-        ++logoName;
-    }
-
-    return false;
-}
-
-static const FFlogo* logoGetBuiltin(const char* name)
-{
-    GetLogoMethod* methods = ffLogoBuiltinGetAll();
-
-    while(*methods != NULL)
-    {
-        const FFlogo* logo = (*methods)();
-
-        if(logoHasName(logo, name))
-            return logo;
-
-        ++methods;
-    }
-
-    return NULL;
-}
-
 static const FFlogo* logoGetBuiltinDetected(const FFinstance* instance)
 {
     const FFOSResult* os = ffDetectOS(instance);
 
-    const FFlogo* logo = logoGetBuiltin(os->id.chars);
+    const FFlogo* logo = ffLogoBuiltinFind(os->id.chars);
     if(logo != NULL)
         return logo;
 
-    logo = logoGetBuiltin(os->name.chars);
+    logo = ffLogoBuiltinFind(os->name.chars);
     if(logo != NULL)
         return logo;
 
-    logo = logoGetBuiltin(os->prettyName.chars);
+    logo = ffLogoBuiltinFind(os->prettyName.chars);
     if(logo != NULL)
         return logo;
 
-    logo = logoGetBuiltin(os->idLike.chars);
+    logo = ffLogoBuiltinFind(os->idLike.chars);
     if(logo != NULL)
         return logo;
 
-    logo = logoGetBuiltin(instance->state.platform.systemName.chars);
+    logo = ffLogoBuiltinFind(instance->state.platform.systemName.chars);
     if(logo != NULL)
         return logo;
 
@@ -266,7 +430,7 @@ static bool logoPrintBuiltinIfExists(FFinstance* instance, const char* name)
         return true;
     }
 
-    const FFlogo* logo = logoGetBuiltin(name);
+    const FFlogo* logo = ffLogoBuiltinFind(name);
     if(logo == NULL)
         return false;
 
@@ -444,7 +608,26 @@ void ffLogoPrint(FFinstance* instance)
 
 void ffLogoPrintLine(FFinstance* instance)
 {
-    if(instance->state.logoWidth > 0)
+    if(instance->state.logoRowInfos.length > 0)
+    {
+        //Print the next composed row padded to the logo width, or blank space once the logo is exhausted
+        uint32_t width = 0;
+        if(instance->state.keysHeight < instance->state.logoRowInfos.length)
+        {
+            const FFLogoRow* row = ffListGet(&instance->state.logoRowInfos, instance->state.keysHeight);
+            if(row->length > 0)
+            {
+                ffPrintCharTimes(' ', instance->config.logo.paddingLeft);
+                fwrite(instance->state.logoRows.chars + row->start, 1, row->length, stdout);
+                //The right padding keeps the style the row ends with, like when printing the logo at once
+                ffPrintCharTimes(' ', instance->config.logo.paddingRight);
+                fputs(FASTFETCH_TEXT_MODIFIER_RESET, stdout);
+                width = instance->config.logo.paddingLeft + row->width + instance->config.logo.paddingRight;
+            }
+        }
+        ffPrintCharTimes(' ', instance->state.logoWidth - width);
+    }
+    else if(instance->state.logoWidth > 0)
         printf("\033[%uC", instance->state.logoWidth);
 
     ++instance->state.keysHeight;
@@ -452,6 +635,39 @@ void ffLogoPrintLine(FFinstance* instance)
 
 void ffLogoPrintRemaining(FFinstance* instance)
 {
+    if(instance->state.logoRowInfos.length > 0)
+    {
+        //Rows printed one after another keep the colors of the previous row, so only the first one needs its style prefix.
+        //Without module output next to them, the right padding is only needed where it is visible
+        FF_STRBUF_AUTO_DESTROY remaining;
+        ffStrbufInitA(&remaining, instance->state.logoRows.length + (instance->state.logoHeight + 1) * (instance->config.logo.paddingLeft + 1) + 8);
+
+        bool styled = false;
+        for(; instance->state.keysHeight <= instance->state.logoHeight; ++instance->state.keysHeight)
+        {
+            if(instance->state.keysHeight < instance->state.logoRowInfos.length)
+            {
+                const FFLogoRow* row = ffListGet(&instance->state.logoRowInfos, instance->state.keysHeight);
+                if(row->length > 0)
+                {
+                    uint32_t skip = styled ? row->prefixLength : 0;
+                    appendCharTimes(&remaining, ' ', instance->config.logo.paddingLeft);
+                    ffStrbufAppendNS(&remaining, row->length - skip, instance->state.logoRows.chars + row->start + skip);
+                    if(row->styledPadding)
+                        appendCharTimes(&remaining, ' ', instance->config.logo.paddingRight);
+                    styled = true;
+                }
+            }
+
+            if(styled && instance->state.keysHeight == instance->state.logoHeight)
+                ffStrbufAppendS(&remaining, FASTFETCH_TEXT_MODIFIER_RESET);
+            ffStrbufAppendC(&remaining, '\n');
+        }
+
+        ffStrbufWriteTo(&remaining, stdout);
+        return;
+    }
+
     while(instance->state.keysHeight <= instance->state.logoHeight)
     {
         ffLogoPrintLine(instance);
@@ -473,6 +689,8 @@ void ffLogoBuiltinPrint(FFinstance* instance)
         //reset everything
         instance->state.logoHeight = 0;
         instance->state.keysHeight = 0;
+        ffStrbufClear(&instance->state.logoRows);
+        instance->state.logoRowInfos.length = 0;
         for(uint8_t i = 0; i < FASTFETCH_LOGO_MAX_COLORS; i++)
             ffStrbufClear(&instance->config.logo.colors[i]);
 
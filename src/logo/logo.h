@@ -23,6 +23,20 @@ void ffLogoPrintChars(FFinstance* instance, const char* data, bool doColorReplac
 const FFlogo* ffLogoBuiltinGetUnknown();
 GetLogoMethod* ffLogoBuiltinGetAll();
 
+// Perfect hash table of all builtin logo names: the bucket of a name picks a displacement, which spreads the names of
+// the bucket over their own slots. Sizes must be powers of two
+#define FF_LOGO_BUCKET_BITS 7
+#define FF_LOGO_BUCKET_COUNT (1u << FF_LOGO_BUCKET_BITS)
+#define FF_LOGO_HASH_BITS 9
+#define FF_LOGO_HASH_SIZE (1u << FF_LOGO_HASH_BITS)
+
+// Case insensitive hash of a name. The top FF_LOGO_BUCKET_BITS bits are its bucket
+uint32_t ffLogoBuiltinHash(const char* name);
+// Slot of a hash with the displacement of its bucket
+uint32_t ffLogoBuiltinSlot(uint32_t hash, uint8_t displacement);
+// Finds a builtin logo by name, case insensitive. Only the getter of the found logo is called. NULL if there is no such logo
+const FFlogo* ffLogoBuiltinFind(const char* name);
+
 //image/image.c
 bool ffLogoPrintImageIfExists(FFinstance* instance, FFLogoType type, bool printError);
 
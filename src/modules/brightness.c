@@ -47,8 +47,8 @@ void ffPrintBrightness(FFinstance* instance)
         else
         {
             ffPrintFormatString(instance, key.chars, 0, NULL, &instance->config.brightness.outputFormat, FF_BRIGHTNESS_NUM_FORMAT_ARGS, (FFformatarg[]) {
-                {FF_FORMAT_ARG_TYPE_STRBUF, &item->value},
-                {FF_FORMAT_ARG_TYPE_FLOAT, &item->name}
+                {FF_FORMAT_ARG_TYPE_FLOAT, &item->value},
+                {FF_FORMAT_ARG_TYPE_STRBUF, &item->name}
             });
         }
 
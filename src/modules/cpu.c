@@ -3,7 +3,7 @@
 #include "detection/cpu/cpu.h"
 
 #define FF_CPU_MODULE_NAME "CPU"
-#define FF_CPU_NUM_FORMAT_ARGS 8
+#define FF_CPU_NUM_FORMAT_ARGS 10
 
 void ffPrintCPU(FFinstance* instance)
 {
@@ -32,7 +32,14 @@ void ffPrintCPU(FFinstance* instance)
         if(cpu->coresOnline > 1)
             printf(" (%u)", cpu->coresOnline);
 
-        if(cpu->frequencyMax > 0.0)
+        if(cpu->clusterCount > 1)
+        {
+            fputs(" @ ", stdout);
+            for(uint8_t i = 0; i < cpu->clusterCount; i++)
+                printf(i == 0 ? "%.9g" : " / %.9g", cpu->clusters[i].frequencyMax);
+            fputs(" GHz", stdout);
+        }
+        else if(cpu->frequencyMax > 0.0)
             printf(" @ %.9g GHz", cpu->frequencyMax);
 
         if(cpu->temperature == cpu->temperature) //FF_CPU_TEMP_UNSET
@@ -42,6 +49,15 @@ void ffPrintCPU(FFinstance* instance)
     }
     else
     {
+        FF_STRBUF_AUTO_DESTROY clusters;
+        ffStrbufInit(&clusters);
+        for(uint8_t i = 0; i < cpu->clusterCount; i++)
+        {
+            if(i > 0)
+                ffStrbufAppendS(&clusters, ", ");
+            ffStrbufAppendF(&clusters, "%u @ %.9g GHz", cpu->clusters[i].cores, cpu->clusters[i].frequencyMax);
+        }
+
         ffPrintFormat(instance, FF_CPU_MODULE_NAME, 0, &instance->config.cpu, FF_CPU_NUM_FORMAT_ARGS, (FFformatarg[]){
             {FF_FORMAT_ARG_TYPE_STRBUF, &cpu->name},
             {FF_FORMAT_ARG_TYPE_STRBUF, &cpu->vendor},
@@ -50,7 +66,9 @@ void ffPrintCPU(FFinstance* instance)
             {FF_FORMAT_ARG_TYPE_UINT16, &cpu->coresOnline},
             {FF_FORMAT_ARG_TYPE_DOUBLE, &cpu->frequencyMin},
             {FF_FORMAT_ARG_TYPE_DOUBLE, &cpu->frequencyMax},
-            {FF_FORMAT_ARG_TYPE_DOUBLE, &cpu->temperature}
+            {FF_FORMAT_ARG_TYPE_DOUBLE, &cpu->temperature},
+            {FF_FORMAT_ARG_TYPE_UINT16, &cpu->packages},
+            {FF_FORMAT_ARG_TYPE_STRBUF, &clusters}
         });
     }
 }
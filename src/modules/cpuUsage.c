@@ -4,16 +4,18 @@
 #include "detection/cpuUsage/cpuUsage.h"
 
 #define FF_CPU_USAGE_MODULE_NAME "CPU Usage"
-#define FF_CPU_USAGE_NUM_FORMAT_ARGS 1
+#define FF_CPU_USAGE_NUM_FORMAT_ARGS 4
 
 void ffPrintCPUUsage(FFinstance* instance)
 {
     double percentage = 0.0/0.0;
-    const char* error = ffGetCpuUsageResult(&percentage);
+    FF_LIST_AUTO_DESTROY cores;
+    ffListInit(&cores, sizeof(double));
+    const char* error = ffGetCpuUsageResult(instance->config.cpuUsageMinInterval, &percentage, &cores);
 
     if(error)
     {
-        ffPrintError(instance, FF_CPU_USAGE_MODULE_NAME, 0, &instance->config.cpu, "%s", error);
+        ffPrintError(instance, FF_CPU_USAGE_MODULE_NAME, 0, &instance->config.cpuUsage, "%s", error);
         return;
     }
 
@@ -36,8 +38,25 @@ void ffPrintCPUUsage(FFinstance* instance)
     }
     else
     {
+        double maxValue = cores.length > 0 ? 0 : percentage, minValue = cores.length > 0 ? 100 : percentage;
+
+        FF_LIST_AUTO_DESTROY coreStrs;
+        ffListInitA(&coreStrs, sizeof(FFstrbuf), cores.length);
+        FF_LIST_FOR_EACH(double, core, cores)
+        {
+            if(*core > maxValue) maxValue = *core;
+            if(*core < minValue) minValue = *core;
+            ffStrbufInitF((FFstrbuf*) ffListAdd(&coreStrs), "%.0f", *core);
+        }
+
         ffPrintFormat(instance, FF_CPU_USAGE_MODULE_NAME, 0, &instance->config.cpuUsage, FF_CPU_USAGE_NUM_FORMAT_ARGS, (FFformatarg[]){
-            {FF_FORMAT_ARG_TYPE_DOUBLE, &percentage}
+            {FF_FORMAT_ARG_TYPE_DOUBLE, &percentage},
+            {FF_FORMAT_ARG_TYPE_DOUBLE, &maxValue},
+            {FF_FORMAT_ARG_TYPE_DOUBLE, &minValue},
+            {FF_FORMAT_ARG_TYPE_LIST, &coreStrs},
         });
+
+        FF_LIST_FOR_EACH(FFstrbuf, coreStr, coreStrs)
+            ffStrbufDestroy(coreStr);
     }
 }
@@ -0,0 +1,76 @@
+#include "fastfetch.h"
+#include "common/printing.h"
+#include "common/parsing.h"
+#include "detection/diskio/diskio.h"
+
+#define FF_DISKIO_MODULE_NAME "Disk IO"
+#define FF_DISKIO_NUM_FORMAT_ARGS 5
+
+static void printDevice(FFinstance* instance, const FFDiskIOResult* device)
+{
+    FF_STRBUF_AUTO_DESTROY key;
+    ffStrbufInit(&key);
+
+    if(instance->config.diskIO.key.length == 0)
+        ffStrbufAppendF(&key, "%s (%s)", FF_DISKIO_MODULE_NAME, device->name.chars);
+    else
+    {
+        ffParseFormatString(&key, &instance->config.diskIO.key, 1, (FFformatarg[]){
+            {FF_FORMAT_ARG_TYPE_STRBUF, &device->name}
+        });
+    }
+
+    FF_STRBUF_AUTO_DESTROY readPretty;
+    ffStrbufInit(&readPretty);
+    ffParseSize(device->bytesReadPerSec, instance->config.binaryPrefixType, &readPretty);
+    ffStrbufAppendS(&readPretty, "/s");
+
+    FF_STRBUF_AUTO_DESTROY writePretty;
+    ffStrbufInit(&writePretty);
+    ffParseSize(device->bytesWrittenPerSec, instance->config.binaryPrefixType, &writePretty);
+    ffStrbufAppendS(&writePretty, "/s");
+
+    uint32_t readsPerSec = (uint32_t) device->readsPerSec;
+    uint32_t writesPerSec = (uint32_t) device->writesPerSec;
+
+    if(instance->config.diskIO.outputFormat.length == 0)
+    {
+        ffPrintLogoAndKey(instance, key.chars, 0, NULL);
+        printf("%s (R) - %s (W), %u / %u IOPS\n", readPretty.chars, writePretty.chars, readsPerSec, writesPerSec);
+    }
+    else
+    {
+        ffPrintFormatString(instance, key.chars, 0, NULL, &instance->config.diskIO.outputFormat, FF_DISKIO_NUM_FORMAT_ARGS, (FFformatarg[]){
+            {FF_FORMAT_ARG_TYPE_STRBUF, &readPretty},
+            {FF_FORMAT_ARG_TYPE_STRBUF, &writePretty},
+            {FF_FORMAT_ARG_TYPE_UINT, &readsPerSec},
+            {FF_FORMAT_ARG_TYPE_UINT, &writesPerSec},
+            {FF_FORMAT_ARG_TYPE_STRBUF, &device->name},
+        });
+    }
+}
+
+void ffPrintDiskIO(FFinstance* instance)
+{
+    FF_LIST_AUTO_DESTROY result;
+    ffListInit(&result, sizeof(FFDiskIOResult));
+    const char* error = ffDetectDiskIO(&result);
+
+    if(error)
+    {
+        ffPrintError(instance, FF_DISKIO_MODULE_NAME, 0, &instance->config.diskIO, "%s", error);
+        return;
+    }
+
+    if(result.length == 0)
+    {
+        ffPrintError(instance, FF_DISKIO_MODULE_NAME, 0, &instance->config.diskIO, "No physical disks found");
+        return;
+    }
+
+    FF_LIST_FOR_EACH(FFDiskIOResult, device, result)
+    {
+        printDevice(instance, device);
+        ffStrbufDestroy(&device->name);
+    }
+}
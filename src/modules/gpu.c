@@ -8,7 +8,7 @@
 #include <stdlib.h>
 
 #define FF_GPU_MODULE_NAME "GPU"
-#define FF_GPU_NUM_FORMAT_ARGS 6
+#define FF_GPU_NUM_FORMAT_ARGS 11
 
 static void printGPUResult(FFinstance* instance, uint8_t index, const FFGPUResult* gpu)
 {
@@ -63,6 +63,16 @@ static void printGPUResult(FFinstance* instance, uint8_t index, const FFGPUResul
         else
             type = "Unknown";
 
+        FF_STRBUF_AUTO_DESTROY dedicatedUsed;
+        ffStrbufInit(&dedicatedUsed);
+        if(gpu->dedicated.used != FF_GPU_VMEM_SIZE_UNSET)
+            ffParseSize(gpu->dedicated.used, instance->config.binaryPrefixType, &dedicatedUsed);
+
+        FF_STRBUF_AUTO_DESTROY dedicatedTotal;
+        ffStrbufInit(&dedicatedTotal);
+        if(gpu->dedicated.total != FF_GPU_VMEM_SIZE_UNSET)
+            ffParseSize(gpu->dedicated.total, instance->config.binaryPrefixType, &dedicatedTotal);
+
         ffPrintFormat(instance, FF_GPU_MODULE_NAME, index, &instance->config.gpu, FF_GPU_NUM_FORMAT_ARGS, (FFformatarg[]){
             {FF_FORMAT_ARG_TYPE_STRBUF, &gpu->vendor},
             {FF_FORMAT_ARG_TYPE_STRBUF, &gpu->name},
@@ -70,6 +80,11 @@ static void printGPUResult(FFinstance* instance, uint8_t index, const FFGPUResul
             {FF_FORMAT_ARG_TYPE_DOUBLE, &gpu->temperature},
             {FF_FORMAT_ARG_TYPE_INT, &gpu->coreCount},
             {FF_FORMAT_ARG_TYPE_STRING, type},
+            {FF_FORMAT_ARG_TYPE_STRBUF, &dedicatedUsed},
+            {FF_FORMAT_ARG_TYPE_STRBUF, &dedicatedTotal},
+            {FF_FORMAT_ARG_TYPE_DOUBLE, &gpu->utilization},
+            {FF_FORMAT_ARG_TYPE_DOUBLE, &gpu->frequencyCurrent},
+            {FF_FORMAT_ARG_TYPE_DOUBLE, &gpu->frequencyMax},
         });
     }
 }
@@ -0,0 +1,109 @@
+#include "FFarena.h"
+
+#ifndef _WIN32
+
+#include <stddef.h>
+#include <sys/mman.h>
+
+#define FF_ARENA_SIZE (64u << 20) // Address space only, pages are not used before they are touched
+#define FF_ARENA_BLOCK_SIZE (16u << 10) // Taken from the range by each thread at once
+#define FF_ARENA_ALIGNMENT 16u
+
+static char* arenaStart; // NULL until the first use, (char*) MAP_FAILED if the range couldn't be reserved
+static uint32_t arenaUsed = FF_ARENA_ALIGNMENT; // The first bytes are the empty string
+
+static __thread char* blockCurrent;
+static __thread char* blockEnd;
+
+static char* getArena(void)
+{
+    char* start = __atomic_load_n(&arenaStart, __ATOMIC_ACQUIRE);
+    if(__builtin_expect(start != NULL, true))
+        return start == (char*) MAP_FAILED ? NULL : start;
+
+    start = mmap(NULL, FF_ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS
+        #ifdef MAP_NORESERVE
+            | MAP_NORESERVE
+        #endif
+        , -1, 0);
+
+    char* expected = NULL;
+    if(!__atomic_compare_exchange_n(&arenaStart, &expected, start, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        //Another thread was faster
+        if(start != (char*) MAP_FAILED)
+            munmap(start, FF_ARENA_SIZE);
+        start = expected;
+    }
+
+    return start == (char*) MAP_FAILED ? NULL : start;
+}
+
+// Takes size bytes from the shared range, NULL if it is exhausted
+static char* reserve(char* arena, uint32_t size)
+{
+    uint32_t offset = __atomic_fetch_add(&arenaUsed, size, __ATOMIC_RELAXED);
+    if(size > FF_ARENA_SIZE || offset > FF_ARENA_SIZE - size)
+        return NULL;
+    return arena + offset;
+}
+
+void* ffArenaAlloc(uint32_t size)
+{
+    char* arena = getArena();
+    if(arena == NULL || size == 0)
+        return NULL;
+
+    size = (size + FF_ARENA_ALIGNMENT - 1) & ~(FF_ARENA_ALIGNMENT - 1);
+
+    if((size_t) (blockEnd - blockCurrent) < size)
+    {
+        //Large buffers get their own allocation, so that the rest of the block isn't wasted
+        if(size > FF_ARENA_BLOCK_SIZE / 4)
+            return reserve(arena, size);
+
+        char* block = reserve(arena, FF_ARENA_BLOCK_SIZE);
+        if(block == NULL)
+            return NULL;
+        blockCurrent = block;
+        blockEnd = block + FF_ARENA_BLOCK_SIZE;
+    }
+
+    void* result = blockCurrent;
+    blockCurrent += size;
+    return result;
+}
+
+char* ffArenaEmptyString(void)
+{
+    return getArena(); // Zero filled by mmap and never handed out
+}
+
+bool ffArenaOwns(const void* ptr)
+{
+    uintptr_t start = (uintptr_t) __atomic_load_n(&arenaStart, __ATOMIC_RELAXED);
+    return start != 0 && start != (uintptr_t) MAP_FAILED && (uintptr_t) ptr - start < FF_ARENA_SIZE;
+}
+
+#else
+
+#include <stddef.h>
+
+void* ffArenaAlloc(uint32_t size)
+{
+    (void) size;
+    return NULL;
+}
+
+char* ffArenaEmptyString(void)
+{
+    return NULL;
+}
+
+bool ffArenaOwns(const void* ptr)
+{
+    (void) ptr;
+    return false;
+}
+
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+#ifndef FASTFETCH_INCLUDED_FFARENA
+#define FASTFETCH_INCLUDED_FFARENA
+
+#include "FFcheckmacros.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bump allocator for buffers which live until the process exits, like the config, platform paths and cached detection results.
+// Every thread allocates from its own block of one reserved address range, so there is no locking.
+// Memory is never freed: FFstrbuf and FFlist recognize arena buffers by their address, move them to a new arena allocation
+// when they grow and skip the free in their destroy functions. Not available on Windows, where the Init*Arena functions
+// fall back to the heap.
+
+// Returns 16 byte aligned memory, or NULL if the arena is not available or exhausted
+FF_C_NODISCARD void* ffArenaAlloc(uint32_t size);
+
+// Empty string inside the arena, so that empty arena buffers are recognized as such too. NULL if the arena is not available
+FF_C_NODISCARD char* ffArenaEmptyString(void);
+
+// True if ptr points into the arena. Cheap, it is only a range check
+FF_C_NODISCARD bool ffArenaOwns(const void* ptr);
+
+#endif
@@ -0,0 +1,127 @@
+#include "FFhashmap.h"
+
+#include <ctype.h>
+
+typedef struct FFhashmapEntry
+{
+    uint32_t hash;
+    uint32_t keyOffset; // Into FFhashmap::keys
+    uint32_t keyLength;
+    uint32_t reserved; // Keeps the value 8 byte aligned
+} FFhashmapEntry;
+
+void ffHashmapInit(FFhashmap* map, uint32_t valueSize, bool ignoreCase)
+{
+    //Values may contain pointers, so keep every element 8 byte aligned
+    ffListInit(&map->entries, (uint32_t) sizeof(FFhashmapEntry) + ((valueSize + 7u) & ~7u));
+    ffStrbufInit(&map->keys);
+    map->slots = NULL;
+    map->slotCount = 0;
+    map->ignoreCase = ignoreCase;
+}
+
+static uint32_t hashKey(const FFhashmap* map, uint32_t keyLength, const char* key)
+{
+    //FNV-1a
+    uint32_t hash = 0x811C9DC5u;
+    for(uint32_t i = 0; i < keyLength; ++i)
+    {
+        hash ^= map->ignoreCase ? (uint8_t) tolower((unsigned char) key[i]) : (uint8_t) key[i];
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+static uint32_t findSlot(const FFhashmap* map, uint32_t hash, uint32_t keyLength, const char* key)
+{
+    uint32_t mask = map->slotCount - 1;
+    uint32_t slot = hash & mask;
+    for(; map->slots[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const FFhashmapEntry* entry = ffListGet(&map->entries, map->slots[slot] - 1);
+        if(entry->hash != hash || entry->keyLength != keyLength)
+            continue;
+
+        const char* entryKey = map->keys.chars + entry->keyOffset;
+        if(map->ignoreCase ? strncasecmp(entryKey, key, keyLength) == 0 : memcmp(entryKey, key, keyLength) == 0)
+            break;
+    }
+    return slot;
+}
+
+void* ffHashmapGet(const FFhashmap* map, uint32_t keyLength, const char* key)
+{
+    if(map->slotCount == 0)
+        return NULL;
+
+    uint32_t slot = findSlot(map, hashKey(map, keyLength, key), keyLength, key);
+    if(map->slots[slot] == 0)
+        return NULL;
+
+    return (char*) ffListGet(&map->entries, map->slots[slot] - 1) + sizeof(FFhashmapEntry);
+}
+
+static void grow(FFhashmap* map)
+{
+    free(map->slots);
+    map->slotCount = map->slotCount == 0 ? 16 : map->slotCount * 2;
+    map->slots = calloc(map->slotCount, sizeof(*map->slots));
+
+    uint32_t mask = map->slotCount - 1;
+    for(uint32_t i = 0; i < map->entries.length; ++i)
+    {
+        const FFhashmapEntry* entry = ffListGet(&map->entries, i);
+        uint32_t slot = entry->hash & mask;
+        while(map->slots[slot] != 0)
+            slot = (slot + 1) & mask;
+        map->slots[slot] = i + 1;
+    }
+}
+
+void* ffHashmapSet(FFhashmap* map, uint32_t keyLength, const char* key, bool* created)
+{
+    if((map->entries.length + 1) * 2 > map->slotCount)
+        grow(map);
+
+    uint32_t hash = hashKey(map, keyLength, key);
+    uint32_t slot = findSlot(map, hash, keyLength, key);
+    if(map->slots[slot] != 0)
+    {
+        if(created != NULL)
+            *created = false;
+        return (char*) ffListGet(&map->entries, map->slots[slot] - 1) + sizeof(FFhashmapEntry);
+    }
+
+    FFhashmapEntry* entry = ffListAdd(&map->entries);
+    entry->hash = hash;
+    entry->keyOffset = map->keys.length;
+    entry->keyLength = keyLength;
+    entry->reserved = 0;
+    ffStrbufAppendNS(&map->keys, keyLength, key);
+    ffStrbufAppendC(&map->keys, '\0');
+    map->slots[slot] = map->entries.length;
+
+    if(created != NULL)
+        *created = true;
+    return (char*) entry + sizeof(FFhashmapEntry);
+}
+
+const char* ffHashmapGetKey(const FFhashmap* map, uint32_t index)
+{
+    const FFhashmapEntry* entry = ffListGet(&map->entries, index);
+    return map->keys.chars + entry->keyOffset;
+}
+
+void* ffHashmapGetValue(const FFhashmap* map, uint32_t index)
+{
+    return (char*) ffListGet(&map->entries, index) + sizeof(FFhashmapEntry);
+}
+
+void ffHashmapDestroy(FFhashmap* map)
+{
+    ffListDestroy(&map->entries);
+    ffStrbufDestroy(&map->keys);
+    free(map->slots);
+    map->slots = NULL;
+    map->slotCount = 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#ifndef FASTFETCH_INCLUDED_FFHASHMAP
+#define FASTFETCH_INCLUDED_FFHASHMAP
+
+#include "FFlist.h"
+#include "FFstrbuf.h"
+#include "FFcheckmacros.h"
+
+#include <string.h>
+
+// Maps strings to values of a fixed size, using open addressing with linear probing.
+// Keys are copied and can have any length. Values are stored in insertion order,
+// pointers to them are only valid until the next ffHashmapSet.
+typedef struct FFhashmap
+{
+    FFlist entries; // FFhashmapEntry, followed by the value
+    FFstrbuf keys; // All keys, each one terminated by '\0'
+    uint32_t* slots; // Index + 1 into entries, 0 if the slot is empty
+    uint32_t slotCount; // Power of two, at least twice the number of entries
+    bool ignoreCase;
+} FFhashmap;
+
+void ffHashmapInit(FFhashmap* map, uint32_t valueSize, bool ignoreCase);
+FF_C_NODISCARD void* ffHashmapGet(const FFhashmap* map, uint32_t keyLength, const char* key);
+FF_C_NODISCARD void* ffHashmapSet(FFhashmap* map, uint32_t keyLength, const char* key, bool* created); //created may be NULL
+FF_C_NODISCARD const char* ffHashmapGetKey(const FFhashmap* map, uint32_t index); //In insertion order
+FF_C_NODISCARD void* ffHashmapGetValue(const FFhashmap* map, uint32_t index); //In insertion order
+void ffHashmapDestroy(FFhashmap* map);
+
+static inline void* ffHashmapGetS(const FFhashmap* map, const char* key)
+{
+    return ffHashmapGet(map, (uint32_t) strlen(key), key);
+}
+
+static inline void* ffHashmapSetS(FFhashmap* map, const char* key, bool* created)
+{
+    return ffHashmapSet(map, (uint32_t) strlen(key), key, created);
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "FFlist.h"
+#include "FFarena.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -11,13 +12,35 @@ void ffListInitA(FFlist* list, uint32_t elementSize, uint32_t capacity)
     list->data = capacity == 0 ? NULL : malloc((size_t)list->capacity * list->elementSize);
 }
 
+void ffListInitArena(FFlist* list, uint32_t elementSize)
+{
+    assert(elementSize > 0);
+    list->elementSize = elementSize;
+    list->capacity = 0;
+    list->length = 0;
+    //Marks the list as arena list. With a capacity of 0 it is never accessed
+    list->data = ffArenaEmptyString();
+}
+
 void* ffListAdd(FFlist* list)
 {
     if(list->length == list->capacity)
     {
         list->capacity = list->capacity == 0 ? FF_LIST_DEFAULT_ALLOC : list->capacity * 2;
-        // realloc(NULL, newSize) is same as malloc(newSize)
-        list->data = realloc(list->data, (size_t)list->capacity * list->elementSize);
+        if(ffArenaOwns(list->data))
+        {
+            //Arena buffers can't be resized, so they move. If the arena is exhausted, to the heap
+            char* data = ffArenaAlloc(list->capacity * list->elementSize);
+            if(data == NULL)
+                data = malloc((size_t)list->capacity * list->elementSize);
+            memcpy(data, list->data, (size_t)list->length * list->elementSize);
+            list->data = data;
+        }
+        else
+        {
+            // realloc(NULL, newSize) is same as malloc(newSize)
+            list->data = realloc(list->data, (size_t)list->capacity * list->elementSize);
+        }
     }
 
     ++list->length;
@@ -60,6 +83,7 @@ void ffListDestroy(FFlist* list)
 {
     //Avoid free-after-use. These 3 assignments are cheap so don't remove them
     list->capacity = list->length = 0;
-    free(list->data);
+    if(!ffArenaOwns(list->data))
+        free(list->data);
     list->data = NULL;
 }
@@ -21,6 +21,7 @@ typedef struct FFlist
 } FFlist;
 
 void ffListInitA(FFlist* list, uint32_t elementSize, uint32_t capacity);
+void ffListInitArena(FFlist* list, uint32_t elementSize); //For lists which live until the process exits, see FFarena.h
 
 void* ffListAdd(FFlist* list);
 
@@ -1,21 +1,82 @@
 #include "FFstrbuf.h"
+#include "FFarena.h"
 
 #include <ctype.h>
 #include <inttypes.h>
 
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
 static char* CHAR_NULL_PTR = "";
 
+// Most strings (names, versions, numbers) fit into the first allocation of FASTFETCH_STRBUF_DEFAULT_ALLOC bytes.
+// These are slots in the arena, and destroyed slots are kept in a per thread free list for the next strbuf.
+// So short strings don't call malloc or free at all. Strings which outgrow their slot move to the heap
+static __thread char* freeSlots;
+
+static char* allocSlot(void)
+{
+    char* slot = freeSlots;
+    if(slot != NULL)
+    {
+        memcpy(&freeSlots, slot, sizeof(freeSlots));
+        return slot;
+    }
+
+    slot = ffArenaAlloc(FASTFETCH_STRBUF_DEFAULT_ALLOC);
+    return slot != NULL ? slot : malloc(FASTFETCH_STRBUF_DEFAULT_ALLOC);
+}
+
+static void freeSlot(char* slot)
+{
+    memcpy(slot, &freeSlots, sizeof(freeSlots));
+    freeSlots = slot;
+}
+
+// Every arena allocation of exactly this size is a slot, including those of arena buffers
+static inline bool isSlot(const FFstrbuf* strbuf)
+{
+    return strbuf->allocated == FASTFETCH_STRBUF_DEFAULT_ALLOC && ffArenaOwns(strbuf->chars);
+}
+
 void ffStrbufInitA(FFstrbuf* strbuf, uint32_t allocate)
 {
-    strbuf->allocated = allocate;
+    if(allocate > 0 && allocate <= FASTFETCH_STRBUF_DEFAULT_ALLOC)
+    {
+        strbuf->allocated = FASTFETCH_STRBUF_DEFAULT_ALLOC;
+        strbuf->chars = allocSlot();
+    }
+    else
+    {
+        strbuf->allocated = allocate;
 
-    if(strbuf->allocated > 0)
-        strbuf->chars = (char*) malloc(sizeof(char) * strbuf->allocated);
+        if(strbuf->allocated > 0)
+            strbuf->chars = (char*) malloc(sizeof(char) * strbuf->allocated);
+        else
+            strbuf->chars = CHAR_NULL_PTR;
+    }
 
     //This will set the length to zero and the null byte.
     ffStrbufClear(strbuf);
 }
 
+void ffStrbufInitArenaA(FFstrbuf* strbuf, uint32_t allocate)
+{
+    strbuf->chars = allocate > 0 ? ffArenaAlloc(allocate) : ffArenaEmptyString();
+    if(strbuf->chars == NULL)
+    {
+        ffStrbufInitA(strbuf, allocate);
+        return;
+    }
+
+    strbuf->allocated = allocate;
+    strbuf->length = 0;
+    strbuf->chars[0] = '\0';
+}
+
 void ffStrbufInitCopy(FFstrbuf* strbuf, const FFstrbuf* src)
 {
     ffStrbufInitA(strbuf, src->allocated);
@@ -64,7 +125,29 @@ void ffStrbufEnsureFree(FFstrbuf* strbuf, uint32_t free)
     while((strbuf->length + free + 1) > allocate) // + 1 for the null byte
         allocate *= 2;
 
-    if(strbuf->allocated == 0)
+    if(strbuf->allocated == 0 && allocate == FASTFETCH_STRBUF_DEFAULT_ALLOC)
+    {
+        //Empty, so there is nothing to copy. Also for empty arena buffers, slots are in the arena too
+        strbuf->chars = allocSlot();
+        strbuf->chars[0] = '\0';
+    }
+    else if(isSlot(strbuf))
+    {
+        char* chars = malloc(sizeof(*strbuf->chars) * allocate);
+        memcpy(chars, strbuf->chars, strbuf->length + 1);
+        freeSlot(strbuf->chars);
+        strbuf->chars = chars;
+    }
+    else if(ffArenaOwns(strbuf->chars))
+    {
+        //Arena buffers can't be resized, so they move. If the arena is exhausted, to the heap
+        char* chars = ffArenaAlloc(allocate);
+        if(chars == NULL)
+            chars = malloc(sizeof(*strbuf->chars) * allocate);
+        memcpy(chars, strbuf->chars, strbuf->length + 1);
+        strbuf->chars = chars;
+    }
+    else if(strbuf->allocated == 0)
     {
         strbuf->chars = malloc(sizeof(*strbuf->chars) * allocate);
         strbuf->chars[0] = '\0';
@@ -79,10 +162,10 @@ void ffStrbufClear(FFstrbuf* strbuf)
 {
     assert(strbuf != NULL);
 
-    if(strbuf->allocated == 0)
-        strbuf->chars = CHAR_NULL_PTR;
-    else
+    if(strbuf->allocated > 0)
         strbuf->chars[0] = '\0';
+    else if(!ffArenaOwns(strbuf->chars)) //Keep the empty string of the arena, so the buffer stays in the arena
+        strbuf->chars = CHAR_NULL_PTR;
 
     strbuf->length = 0;
 }
@@ -149,7 +232,7 @@ void ffStrbufAppendVF(FFstrbuf* strbuf, const char* format, va_list arguments)
     uint32_t free = ffStrbufGetFree(strbuf);
     int written = vsnprintf(strbuf->chars + strbuf->length, strbuf->allocated > 0 ? free + 1 : 0, format, arguments);
 
-    if(written > 0 && strbuf->length + (uint32_t) written > free)
+    if(written > 0 && (uint32_t) written > free)
     {
         ffStrbufEnsureFree(strbuf, (uint32_t) written);
         written = vsnprintf(strbuf->chars + strbuf->length, (uint32_t) written + 1, format, copy);
@@ -198,6 +281,197 @@ void ffStrbufAppendF(FFstrbuf* strbuf, const char* format, ...)
     va_end(arguments);
 }
 
+static const char digitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Writes the digits of value backwards, ending before end. Returns the first digit
+static char* writeDigits(char* end, uint64_t value)
+{
+    while(value >= 100)
+    {
+        end -= 2;
+        memcpy(end, digitPairs + (value % 100) * 2, 2);
+        value /= 100;
+    }
+
+    if(value >= 10)
+    {
+        end -= 2;
+        memcpy(end, digitPairs + value * 2, 2);
+    }
+    else
+        *--end = (char) ('0' + value);
+
+    return end;
+}
+
+void ffStrbufAppendUInt(FFstrbuf* strbuf, uint64_t value)
+{
+    char buffer[20]; // UINT64_MAX has 20 digits
+    char* start = writeDigits(buffer + sizeof(buffer), value);
+    ffStrbufAppendNS(strbuf, (uint32_t) (buffer + sizeof(buffer) - start), start);
+}
+
+void ffStrbufAppendSInt(FFstrbuf* strbuf, int64_t value)
+{
+    if(value < 0)
+    {
+        ffStrbufAppendC(strbuf, '-');
+        ffStrbufAppendUInt(strbuf, 0 - (uint64_t) value);
+    }
+    else
+        ffStrbufAppendUInt(strbuf, (uint64_t) value);
+}
+
+static const double powersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10 };
+static const double negativePowersOf10[] = { 1e0, 1e-1, 1e-2, 1e-3, 1e-4, 1e-5 };
+
+// Exact error of value * scale, so that value * scale == product + error
+static inline double productError(double value, double scale, double product)
+{
+    #ifdef __FP_FAST_FMA
+        return __builtin_fma(value, scale, -product);
+    #else
+        //Dekker's product. Without a fma instruction the compiler can't contract it either
+        const double split = 134217729.0; // 2^27 + 1
+        double t = split * value;
+        double valueHigh = t - (t - value);
+        double valueLow = value - valueHigh;
+        t = split * scale;
+        double scaleHigh = t - (t - scale);
+        double scaleLow = scale - scaleHigh;
+        return ((valueHigh * scaleHigh - product) + valueHigh * scaleLow + valueLow * scaleHigh) + valueLow * scaleLow;
+    #endif
+}
+
+// value * 10^precision rounded to an integer half to even, like printf does it. value must be >= 0.
+// False if the result doesn't fit into the mantissa, or for NaN
+static bool roundScaled(double value, uint32_t precision, uint64_t* result)
+{
+    double scale = powersOf10[precision];
+    double scaled = value * scale;
+    if(!(scaled < 4503599627370496.0)) // 2^52, so that the fraction of scaled is exact
+        return false;
+
+    uint64_t integer = (uint64_t) scaled;
+    double fraction = scaled - (double) integer;
+
+    if(fraction > 0.5)
+        ++integer;
+    else if(fraction == 0.5)
+    {
+        //The rounding of the product only matters if it produced a tie. Then the exact product decides
+        double error = productError(value, scale, scaled);
+        if(error > 0 || (error == 0 && integer % 2 == 1))
+            ++integer;
+    }
+
+    *result = integer;
+    return true;
+}
+
+static void appendFixed(FFstrbuf* strbuf, uint64_t scaled, uint32_t precision, bool trimZeros)
+{
+    uint64_t scale = (uint64_t) powersOf10[precision];
+    uint64_t fraction = scaled % scale;
+    ffStrbufAppendUInt(strbuf, scaled / scale);
+
+    if(trimZeros)
+    {
+        while(precision > 0 && fraction % 10 == 0)
+        {
+            fraction /= 10;
+            --precision;
+        }
+    }
+
+    if(precision == 0)
+        return;
+
+    char buffer[16];
+    buffer[0] = '.';
+    memset(buffer + 1, '0', precision);
+    writeDigits(buffer + 1 + precision, fraction);
+    ffStrbufAppendNS(strbuf, precision + 1, buffer);
+}
+
+// Like "%g": 6 significant digits without trailing zeros. False if the exponent notation would be used
+static bool appendGeneral(FFstrbuf* strbuf, double value)
+{
+    if(value == 0)
+    {
+        ffStrbufAppendC(strbuf, '0');
+        return true;
+    }
+
+    if(!(value < 1e6))
+        return false;
+
+    //Estimate of the decimal exponent, corrected below if the rounding reaches the next power of ten
+    int exponent = 5;
+    while(exponent > -5 && value < (exponent >= 0 ? powersOf10[exponent] : negativePowersOf10[-exponent]))
+        --exponent;
+
+    uint64_t scaled;
+    if(!roundScaled(value, (uint32_t) (5 - exponent), &scaled))
+        return false;
+
+    if(scaled >= 1000000)
+    {
+        if(++exponent > 5 || !roundScaled(value, (uint32_t) (5 - exponent), &scaled))
+            return false;
+    }
+    else if(scaled < 100000)
+    {
+        if(--exponent < -5 || !roundScaled(value, (uint32_t) (5 - exponent), &scaled))
+            return false;
+    }
+
+    if(exponent < -4)
+        return false;
+
+    appendFixed(strbuf, scaled, (uint32_t) (5 - exponent), true);
+    return true;
+}
+
+void ffStrbufAppendDouble(FFstrbuf* strbuf, double value, int8_t precision)
+{
+    if(precision <= 9)
+    {
+        bool negative = __builtin_signbit(value);
+        double absolute = negative ? -value : value;
+        uint32_t length = strbuf->length;
+        if(negative)
+            ffStrbufAppendC(strbuf, '-');
+
+        uint64_t scaled;
+        if(precision < 0 ? appendGeneral(strbuf, absolute) : roundScaled(absolute, (uint32_t) precision, &scaled))
+        {
+            if(precision >= 0)
+                appendFixed(strbuf, scaled, (uint32_t) precision, false);
+            return;
+        }
+
+        //Infinite, NaN, too large or too small for the fast path
+        if(negative)
+            ffStrbufSubstrBefore(strbuf, length);
+    }
+
+    if(precision < 0)
+        ffStrbufAppendF(strbuf, "%g", value);
+    else
+        ffStrbufAppendF(strbuf, "%.*f", (int) precision, value);
+}
+
 void ffStrbufPrependNS(FFstrbuf* strbuf, uint32_t length, const char* value)
 {
     if(value == NULL || length == 0)
@@ -226,9 +500,12 @@ void ffStrbufTrimLeft(FFstrbuf* strbuf, char c)
     if(strbuf->length == 0) //`allocated == 0` implies `length == 0`
         return;
 
-    uint32_t index = 0;
-    while(index < strbuf->length && strbuf->chars[index] == c)
-        ++index;
+    const char* ptr = strbuf->chars;
+    const char* end = strbuf->chars + strbuf->length;
+    while(ptr < end && *ptr == c)
+        ++ptr;
+
+    uint32_t index = (uint32_t) (ptr - strbuf->chars);
 
     if(index == 0)
         return;
@@ -243,7 +520,7 @@ void ffStrbufTrimRight(FFstrbuf* strbuf, char c)
     if(strbuf->length == 0)
         return;
 
-    while(ffStrbufEndsWithC(strbuf, c))
+    while(strbuf->length > 0 && strbuf->chars[strbuf->length - 1] == c)
         --strbuf->length;
 
     strbuf->chars[strbuf->length] = '\0';
@@ -274,9 +551,27 @@ void ffStrbufRemoveSubstr(FFstrbuf* strbuf, uint32_t startIndex, uint32_t endInd
 void ffStrbufRemoveS(FFstrbuf* strbuf, const char* str)
 {
     uint32_t stringLength = (uint32_t) strlen(str);
+    if(stringLength == 0 || strbuf->length < stringLength)
+        return;
+
+    const char* match = strstr(strbuf->chars, str);
+    if(match == NULL)
+        return;
+
+    //Removes all matches in one pass, instead of moving the rest of the string once per match
+    char* write = (char*) match;
+    const char* read = match + stringLength;
+    while((match = strstr(read, str)) != NULL)
+    {
+        memmove(write, read, (size_t) (match - read));
+        write += match - read;
+        read = match + stringLength;
+    }
 
-    for(uint32_t i = ffStrbufNextIndexS(strbuf, 0, str); i < strbuf->length; i = ffStrbufNextIndexS(strbuf, i, str))
-        ffStrbufRemoveSubstr(strbuf, i, i + stringLength);
+    uint32_t rest = (uint32_t) (strbuf->chars + strbuf->length - read);
+    memmove(write, read, rest);
+    write[rest] = '\0';
+    strbuf->length = (uint32_t) (write - strbuf->chars) + rest;
 }
 
 void ffStrbufRemoveStringsA(FFstrbuf* strbuf, uint32_t numStrings, const char* strings[])
@@ -319,13 +614,18 @@ uint32_t ffStrbufPreviousIndexC(const FFstrbuf* strbuf, uint32_t start, char c)
 {
     assert(start <= strbuf->length);
 
-    //We need to loop one higher than the actual index, because uint32_t is guranteed to be >= 0, so this statement would always be true
-    for(uint32_t i = start + 1; i > 0; i--)
-    {
-        if(strbuf->chars[i - 1] == c)
-            return i - 1;
-    }
-    return strbuf->length;
+    #if defined(__linux__) || defined(__FreeBSD__)
+        const char* ptr = (const char*)memrchr(strbuf->chars, c, start + 1);
+        return ptr ? (uint32_t)(ptr - strbuf->chars) : strbuf->length;
+    #else
+        //We need to loop one higher than the actual index, because uint32_t is guranteed to be >= 0, so this statement would always be true
+        for(uint32_t i = start + 1; i > 0; i--)
+        {
+            if(strbuf->chars[i - 1] == c)
+                return i - 1;
+        }
+        return strbuf->length;
+    #endif
 }
 
 void ffStrbufReplaceAllC(FFstrbuf* strbuf, char find, char replace)
@@ -393,7 +693,38 @@ void ffStrbufSubstrAfterLastC(FFstrbuf* strbuf, char c)
 uint32_t ffStrbufCountC(const FFstrbuf* strbuf, char c)
 {
     uint32_t result = 0;
-    for(uint32_t i = 0; i < strbuf->length; i++)
+    uint32_t i = 0;
+
+    //16 bytes at once. SSE2 and NEON are part of the x86_64 and aarch64 base line, so there is nothing to detect at runtime
+    #if defined(__SSE2__)
+        //Matches are counted per byte lane (cmpeq gives -1), and summed up before a lane can overflow
+        const __m128i needle = _mm_set1_epi8(c);
+        while(i + 16 <= strbuf->length)
+        {
+            __m128i counts = _mm_setzero_si128();
+            for(uint32_t blocks = 0; blocks < 255 && i + 16 <= strbuf->length; ++blocks, i += 16)
+            {
+                __m128i block = _mm_loadu_si128((const __m128i*) (strbuf->chars + i));
+                counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(block, needle));
+            }
+            __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+            result += (uint32_t) (_mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4));
+        }
+    #elif defined(__ARM_NEON) && defined(__aarch64__)
+        const uint8x16_t needle = vdupq_n_u8((uint8_t) c);
+        while(i + 16 <= strbuf->length)
+        {
+            uint8x16_t counts = vdupq_n_u8(0);
+            for(uint32_t blocks = 0; blocks < 255 && i + 16 <= strbuf->length; ++blocks, i += 16)
+            {
+                uint8x16_t block = vld1q_u8((const uint8_t*) (strbuf->chars + i));
+                counts = vsubq_u8(counts, vceqq_u8(block, needle));
+            }
+            result += vaddlvq_u8(counts);
+        }
+    #endif
+
+    for(; i < strbuf->length; i++)
     {
         if(strbuf->chars[i] == c)
             result++;
@@ -450,8 +781,12 @@ void ffStrbufDestroy(FFstrbuf* strbuf)
 {
     if(strbuf->allocated == 0) return;
 
+    if(isSlot(strbuf))
+        freeSlot(strbuf->chars);
+    else if(!ffArenaOwns(strbuf->chars))
+        free(strbuf->chars);
+
     //Avoid free-after-use. These 3 assignments are cheap so don't remove them
     strbuf->allocated = strbuf->length = 0;
-    free(strbuf->chars);
     strbuf->chars = CHAR_NULL_PTR;
 }
@@ -30,6 +30,7 @@ typedef struct FFstrbuf
 #define FF_STRBUF_CREATE(name) FFstrbuf name; ffStrbufInit(&name);
 
 void ffStrbufInitA(FFstrbuf* strbuf, uint32_t allocate);
+void ffStrbufInitArenaA(FFstrbuf* strbuf, uint32_t allocate); //For buffers which live until the process exits, see FFarena.h
 void ffStrbufInitCopy(FFstrbuf* strbuf, const FFstrbuf* src);
 void ffStrbufInitF(FFstrbuf* strbuf, const char* format, ...);
 void ffStrbufInitVF(FFstrbuf* strbuf, const char* format, va_list arguments);
@@ -47,6 +48,9 @@ void ffStrbufAppendTransformS(FFstrbuf* strbuf, const char* value, int(*transfor
 FF_C_PRINTF(2, 3) void ffStrbufAppendF(FFstrbuf* strbuf, const char* format, ...);
 void ffStrbufAppendVF(FFstrbuf* strbuf, const char* format, va_list arguments);
 void ffStrbufAppendSUntilC(FFstrbuf* strbuf, const char* value, char until);
+void ffStrbufAppendUInt(FFstrbuf* strbuf, uint64_t value);
+void ffStrbufAppendSInt(FFstrbuf* strbuf, int64_t value);
+void ffStrbufAppendDouble(FFstrbuf* strbuf, double value, int8_t precision); //Like "%.<precision>f", or "%g" if precision is negative. Same output as printf
 
 void ffStrbufPrependNS(FFstrbuf* strbuf, uint32_t length, const char* value);
 
@@ -118,6 +122,17 @@ static inline void ffStrbufInit(FFstrbuf* strbuf)
     ffStrbufInitA(strbuf, 0);
 }
 
+static inline void ffStrbufInitArena(FFstrbuf* strbuf)
+{
+    ffStrbufInitArenaA(strbuf, 0);
+}
+
+static inline void ffStrbufInitArenaS(FFstrbuf* strbuf, const char* str)
+{
+    ffStrbufInitArena(strbuf);
+    ffStrbufAppendS(strbuf, str);
+}
+
 static inline void ffStrbufInitNS(FFstrbuf* strbuf, uint32_t length, const char* str)
 {
     ffStrbufInit(strbuf);
@@ -3,10 +3,10 @@
 #ifndef FASTFETCH_INCLUDED_FFVALUESTORE
 #define FASTFETCH_INCLUDED_FFVALUESTORE
 
-#include "FFlist.h"
+#include "FFhashmap.h"
 #include "FFcheckmacros.h"
 
-typedef FFlist FFvaluestore;
+typedef FFhashmap FFvaluestore;
 
 void ffValuestoreInit(FFvaluestore* vs, uint32_t valueSize);
 FF_C_NODISCARD void* ffValuestoreGet(FFvaluestore* vs, const char* key);
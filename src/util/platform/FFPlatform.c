@@ -3,20 +3,20 @@
 
 void ffPlatformInit(FFPlatform* platform)
 {
-    ffStrbufInit(&platform->homeDir);
-    ffStrbufInit(&platform->cacheDir);
-    ffListInit(&platform->configDirs, sizeof(FFstrbuf));
-    ffListInit(&platform->dataDirs, sizeof(FFstrbuf));
+    ffStrbufInitArena(&platform->homeDir);
+    ffStrbufInitArena(&platform->cacheDir);
+    ffListInitArena(&platform->configDirs, sizeof(FFstrbuf));
+    ffListInitArena(&platform->dataDirs, sizeof(FFstrbuf));
 
-    ffStrbufInit(&platform->userName);
-    ffStrbufInit(&platform->hostName);
-    ffStrbufInit(&platform->domainName);
-    ffStrbufInit(&platform->userShell);
+    ffStrbufInitArena(&platform->userName);
+    ffStrbufInitArena(&platform->hostName);
+    ffStrbufInitArena(&platform->domainName);
+    ffStrbufInitArena(&platform->userShell);
 
-    ffStrbufInit(&platform->systemName);
-    ffStrbufInit(&platform->systemRelease);
-    ffStrbufInit(&platform->systemVersion);
-    ffStrbufInit(&platform->systemArchitecture);
+    ffStrbufInitArena(&platform->systemName);
+    ffStrbufInitArena(&platform->systemRelease);
+    ffStrbufInitArena(&platform->systemVersion);
+    ffStrbufInitArena(&platform->systemArchitecture);
 
     ffPlatformInitImpl(platform);
 
@@ -69,7 +69,7 @@ void ffPlatformDestroy(FFPlatform* platform)
 void ffPlatformPathAddAbsolute(FFlist* dirs, const char* path)
 {
     FFstrbuf* buffer = (FFstrbuf*) ffListAdd(dirs);
-    ffStrbufInitA(buffer, 64);
+    ffStrbufInitArenaA(buffer, 64);
     ffStrbufAppendS(buffer, path);
     ffStrbufEnsureEndsWithC(buffer, '/');
     FF_PLATFORM_PATH_UNIQUE(dirs, buffer);
@@ -78,7 +78,7 @@ void ffPlatformPathAddAbsolute(FFlist* dirs, const char* path)
 void ffPlatformPathAddHome(FFlist* dirs, const FFPlatform* platform, const char* suffix)
 {
     FFstrbuf* buffer = (FFstrbuf*) ffListAdd(dirs);
-    ffStrbufInitA(buffer, 64);
+    ffStrbufInitArenaA(buffer, 64);
     ffStrbufAppend(buffer, &platform->homeDir);
     ffStrbufAppendS(buffer, suffix);
     ffStrbufEnsureEndsWithC(buffer, '/');
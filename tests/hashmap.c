@@ -0,0 +1,86 @@
+#include "util/FFhashmap.h"
+#include "util/textModifier.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+__attribute__((__noreturn__))
+static void testFailed(const char* expression, int lineNo)
+{
+    fputs(FASTFETCH_TEXT_MODIFIER_ERROR, stderr);
+    fprintf(stderr, "[%d] %s\n", lineNo, expression);
+    fputs(FASTFETCH_TEXT_MODIFIER_RESET, stderr);
+    exit(1);
+}
+
+#define VERIFY(expression) if(!(expression)) testFailed(#expression, __LINE__)
+
+int main(void)
+{
+    FFhashmap map;
+    bool created;
+
+    //init
+    ffHashmapInit(&map, sizeof(uint32_t), false);
+    VERIFY(map.entries.length == 0);
+    VERIFY(ffHashmapGetS(&map, "") == NULL);
+    VERIFY(ffHashmapGetS(&map, "a") == NULL);
+
+    //set
+    *(uint32_t*) ffHashmapSetS(&map, "a", &created) = 1;
+    VERIFY(created);
+    VERIFY(*(uint32_t*) ffHashmapGetS(&map, "a") == 1);
+    *(uint32_t*) ffHashmapSetS(&map, "a", &created) = 2;
+    VERIFY(!created);
+    VERIFY(map.entries.length == 1);
+    VERIFY(*(uint32_t*) ffHashmapGetS(&map, "a") == 2);
+
+    //case sensitive
+    VERIFY(ffHashmapGetS(&map, "A") == NULL);
+
+    //keys are not truncated and can be views
+    const char* longKey = "a key which is much longer than thirty one characters";
+    *(uint32_t*) ffHashmapSetS(&map, longKey, NULL) = 3;
+    VERIFY(*(uint32_t*) ffHashmapGetS(&map, longKey) == 3);
+    VERIFY(ffHashmapGet(&map, 31, longKey) == NULL);
+    VERIFY(*(uint32_t*) ffHashmapGet(&map, 1, longKey) == 2);
+
+    //grow
+    char key[16];
+    for(uint32_t i = 0; i < 1000; ++i)
+    {
+        snprintf(key, sizeof(key), "key%u", i);
+        *(uint32_t*) ffHashmapSetS(&map, key, &created) = i;
+        VERIFY(created);
+    }
+    VERIFY(map.entries.length == 1002);
+    VERIFY(map.slotCount >= map.entries.length * 2);
+    for(uint32_t i = 0; i < 1000; ++i)
+    {
+        snprintf(key, sizeof(key), "key%u", i);
+        VERIFY(*(uint32_t*) ffHashmapGetS(&map, key) == i);
+    }
+    VERIFY(ffHashmapGetS(&map, "key1000") == NULL);
+
+    //insertion order
+    VERIFY(strcmp(ffHashmapGetKey(&map, 0), "a") == 0);
+    VERIFY(strcmp(ffHashmapGetKey(&map, 1), longKey) == 0);
+    VERIFY(*(uint32_t*) ffHashmapGetValue(&map, 2) == 0);
+
+    //destroy
+    ffHashmapDestroy(&map);
+    VERIFY(map.entries.length == 0);
+    VERIFY(map.slotCount == 0);
+    VERIFY(ffHashmapGetS(&map, "a") == NULL);
+
+    //case insensitive
+    ffHashmapInit(&map, sizeof(uint32_t), true);
+    *(uint32_t*) ffHashmapSetS(&map, "--Logo-Type", NULL) = 4;
+    VERIFY(*(uint32_t*) ffHashmapGetS(&map, "--logo-type") == 4);
+    VERIFY(*(uint32_t*) ffHashmapGetS(&map, "--LOGO-TYPE") == 4);
+    VERIFY(ffHashmapGetS(&map, "--logo-typ") == NULL);
+    ffHashmapDestroy(&map);
+
+    //Success
+    puts("\033[32mAll tests passed!"FASTFETCH_TEXT_MODIFIER_RESET);
+}
@@ -0,0 +1,219 @@
+#include "logo/logo.h"
+#include "util/textModifier.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+typedef struct LogoName
+{
+    const char* name;
+    uint8_t index; // Index + 1 into ffLogoBuiltinGetAll()
+    uint32_t hash;
+} LogoName;
+
+static LogoName names[FF_LOGO_HASH_SIZE];
+static uint32_t namesCount;
+
+// Prints the tables which match the current builtin logos, to be pasted into logo/builtin.c
+__attribute__((__noreturn__))
+static void tablesOutdated(const char* name)
+{
+    fputs(FASTFETCH_TEXT_MODIFIER_ERROR, stderr);
+    fprintf(stderr, "%s is not found through the hash table. ", name);
+
+    // Buckets with the most names first, while there are still many free slots
+    uint32_t bucketSizes[FF_LOGO_BUCKET_COUNT] = {0};
+    for(uint32_t i = 0; i < namesCount; ++i)
+        ++bucketSizes[names[i].hash >> (32 - FF_LOGO_BUCKET_BITS)];
+
+    uint8_t displacements[FF_LOGO_BUCKET_COUNT] = {0};
+    uint8_t slots[FF_LOGO_HASH_SIZE] = {0};
+
+    for(uint32_t size = namesCount; size > 0; --size)
+    {
+        for(uint32_t bucket = 0; bucket < FF_LOGO_BUCKET_COUNT; ++bucket)
+        {
+            if(bucketSizes[bucket] != size)
+                continue;
+
+            uint32_t displacement = 0;
+            for(; displacement <= UINT8_MAX; ++displacement)
+            {
+                uint8_t trial[FF_LOGO_HASH_SIZE];
+                memcpy(trial, slots, sizeof(slots));
+
+                bool fits = true;
+                for(uint32_t i = 0; i < namesCount && fits; ++i)
+                {
+                    if(names[i].hash >> (32 - FF_LOGO_BUCKET_BITS) != bucket)
+                        continue;
+
+                    uint32_t slot = ffLogoBuiltinSlot(names[i].hash, (uint8_t) displacement);
+                    fits = trial[slot] == 0;
+                    trial[slot] = names[i].index;
+                }
+
+                if(fits)
+                {
+                    memcpy(slots, trial, sizeof(slots));
+                    break;
+                }
+            }
+
+            if(displacement > UINT8_MAX)
+            {
+                fputs("No displacement fits, increase FF_LOGO_HASH_BITS\n", stderr);
+                fputs(FASTFETCH_TEXT_MODIFIER_RESET, stderr);
+                exit(1);
+            }
+            displacements[bucket] = (uint8_t) displacement;
+        }
+    }
+
+    fputs("Replace logoDisplacements with:\n", stderr);
+    for(uint32_t i = 0; i < FF_LOGO_BUCKET_COUNT; ++i)
+        fprintf(stderr, "%s%3u,%s", i % 16 == 0 ? "    " : "", displacements[i], i % 16 == 15 ? "\n" : "");
+    fputs("and logoSlots with:\n", stderr);
+    for(uint32_t i = 0; i < FF_LOGO_HASH_SIZE; ++i)
+        fprintf(stderr, "%s%3u,%s", i % 16 == 0 ? "    " : "", slots[i], i % 16 == 15 ? "\n" : "");
+    fputs(FASTFETCH_TEXT_MODIFIER_RESET, stderr);
+    exit(1);
+}
+
+__attribute__((__noreturn__))
+static void testFailed(const char* expression, int lineNo)
+{
+    fputs(FASTFETCH_TEXT_MODIFIER_ERROR, stderr);
+    fprintf(stderr, "[%d] %s\n", lineNo, expression);
+    fputs(FASTFETCH_TEXT_MODIFIER_RESET, stderr);
+    exit(1);
+}
+
+#define VERIFY(expression) if(!(expression)) testFailed(#expression, __LINE__)
+
+// Bytes written to stdout when printing the logo at once, or composed and printed with ffLogoPrintRemaining
+static off_t printedSize(FFinstance* instance, const FFlogo* logo, bool printRemaining)
+{
+    fflush(stdout);
+    FILE* file = tmpfile();
+    VERIFY(file != NULL);
+    int savedStdout = dup(STDOUT_FILENO);
+    dup2(fileno(file), STDOUT_FILENO);
+
+    instance->config.logo.printRemaining = printRemaining;
+    instance->state.keysHeight = 0;
+    ffLogoPrintChars(instance, logo->data, true);
+    if(printRemaining)
+        ffLogoPrintRemaining(instance);
+    fflush(stdout);
+
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+
+    struct stat fileInfo;
+    VERIFY(fstat(fileno(file), &fileInfo) == 0);
+    fclose(file);
+    return fileInfo.st_size;
+}
+
+static bool rowPrefixIs(const FFinstance* instance, uint32_t index, const char* prefix)
+{
+    const FFLogoRow* row = ffListGet(&instance->state.logoRowInfos, index);
+    return row->prefixLength == strlen(prefix) && memcmp(instance->state.logoRows.chars + row->start, prefix, row->prefixLength) == 0;
+}
+
+int main(void)
+{
+    GetLogoMethod* methods = ffLogoBuiltinGetAll();
+    for(uint32_t i = 0; methods[i] != NULL; ++i)
+    {
+        VERIFY(i < UINT8_MAX);
+
+        for(const char** name = methods[i]()->names; *name != NULL; ++name)
+        {
+            // If two logos share a name, the first one wins, like in the old linear search
+            bool duplicate = false;
+            for(uint32_t j = 0; j < namesCount && !duplicate; ++j)
+                duplicate = strcasecmp(names[j].name, *name) == 0;
+            if(duplicate)
+                continue;
+
+            VERIFY(namesCount < FF_LOGO_HASH_SIZE);
+            names[namesCount++] = (LogoName) { *name, (uint8_t) (i + 1), ffLogoBuiltinHash(*name) };
+        }
+    }
+
+    //Every name must have its own slot
+    for(uint32_t i = 0; i < namesCount; ++i)
+    {
+        if(ffLogoBuiltinFind(names[i].name) != methods[names[i].index - 1]())
+            tablesOutdated(names[i].name);
+    }
+
+    //Case insensitive
+    VERIFY(ffLogoBuiltinFind("arch") != NULL);
+    VERIFY(ffLogoBuiltinFind("ARCH") == ffLogoBuiltinFind("arch"));
+    VERIFY(ffLogoBuiltinFind("?") == ffLogoBuiltinGetUnknown());
+
+    //Unknown names
+    VERIFY(ffLogoBuiltinFind("") == NULL);
+    VERIFY(ffLogoBuiltinFind("arc") == NULL);
+    VERIFY(ffLogoBuiltinFind("notalogo") == NULL);
+
+    //Composed logos must not be larger than the ones printed at once, rows only repeat the colors in effect
+    FFinstance instance;
+    ffInitInstance(&instance);
+    instance.config.logo.paddingTop = 1;
+    instance.config.logo.paddingLeft = 2;
+    for(uint32_t i = 0; methods[i] != NULL; ++i)
+    {
+        const FFlogo* logo = methods[i]();
+
+        uint32_t maxColorLength = 0;
+        for(uint32_t j = 0; j < FASTFETCH_LOGO_MAX_COLORS; ++j)
+            ffStrbufClear(&instance.config.logo.colors[j]);
+        for(uint32_t j = 0; j < FASTFETCH_LOGO_MAX_COLORS && logo->builtinColors[j] != NULL; ++j)
+        {
+            ffStrbufSetS(&instance.config.logo.colors[j], logo->builtinColors[j]);
+            if(instance.config.logo.colors[j].length > maxColorLength)
+                maxColorLength = instance.config.logo.colors[j].length;
+        }
+
+        off_t atOnce = printedSize(&instance, logo, false);
+        off_t composed = printedSize(&instance, logo, true);
+        if(composed > atOnce)
+        {
+            fprintf(stderr, "%s: composed %ld bytes, at once %ld bytes\n", logo->names[0], (long) composed, (long) atOnce);
+            VERIFY(composed <= atOnce);
+        }
+
+        VERIFY(instance.state.logoRowInfos.length == instance.state.logoHeight + 1);
+        FF_LIST_FOR_EACH(FFLogoRow, row, instance.state.logoRowInfos)
+            VERIFY(row->prefixLength <= strlen(FASTFETCH_TEXT_MODIFIER_BOLT) + maxColorLength + 3);
+    }
+
+    //Composed rows start with every attribute and color still in effect, each one kept in its own slot
+    instance.config.logo.paddingTop = 0;
+    instance.config.logo.printRemaining = true;
+    ffLogoPrintChars(&instance, "\033[44m\033[37mAAAA\nBBBB\n\033[4mCC\033[39mCC\n\033[24;22;49mDDDD\033[0m\nEEEE", false);
+    VERIFY(instance.state.logoRowInfos.length == 5);
+    VERIFY(rowPrefixIs(&instance, 0, FASTFETCH_TEXT_MODIFIER_BOLT));
+    VERIFY(rowPrefixIs(&instance, 1, "\033[1;37;44m"));
+    VERIFY(rowPrefixIs(&instance, 2, "\033[1;37;44m"));
+    VERIFY(rowPrefixIs(&instance, 3, "\033[1;4;44m"));
+    VERIFY(rowPrefixIs(&instance, 4, ""));
+
+    //Extended colors replace the previous color of their slot
+    ffLogoPrintChars(&instance, "\033[31;48;5;200mA\n\033[38;2;1;2;3;1mB\n\033[41mC\nD", false);
+    VERIFY(rowPrefixIs(&instance, 1, "\033[1;31;48;5;200m"));
+    VERIFY(rowPrefixIs(&instance, 2, "\033[1;38;2;1;2;3;48;5;200m"));
+    VERIFY(rowPrefixIs(&instance, 3, "\033[1;38;2;1;2;3;41m"));
+
+    ffDestroyInstance(&instance);
+
+    //Success
+    puts("\033[32mAll tests passed!"FASTFETCH_TEXT_MODIFIER_RESET);
+}
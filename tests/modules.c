@@ -0,0 +1,82 @@
+#include "common/modules.h"
+#include "util/textModifier.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+// Prints the slot table which matches the current ffModules, to be pasted into common/modules.c
+__attribute__((__noreturn__))
+static void slotsOutdated(const char* name)
+{
+    fputs(FASTFETCH_TEXT_MODIFIER_ERROR, stderr);
+    fprintf(stderr, "%s is not found through the hash table. ", name);
+
+    uint8_t slots[FF_MODULE_HASH_SIZE] = {0};
+    for(uint32_t i = 0; i < ffModulesCount; ++i)
+    {
+        const char* names[] = { ffModules[i].name, ffModules[i].alias };
+        for(uint32_t j = 0; j < 2; ++j)
+        {
+            if(names[j] == NULL)
+                continue;
+
+            uint32_t slot = ffModuleHash(names[j]);
+            if(slots[slot] != 0)
+            {
+                fprintf(stderr, "%s collides with %s, choose another FF_MODULE_HASH_SEED\n", names[j], ffModules[slots[slot] - 1].name);
+                fputs(FASTFETCH_TEXT_MODIFIER_RESET, stderr);
+                exit(1);
+            }
+            slots[slot] = (uint8_t) (i + 1);
+        }
+    }
+
+    fputs("Replace moduleSlots with:\n", stderr);
+    for(uint32_t i = 0; i < FF_MODULE_HASH_SIZE; ++i)
+        fprintf(stderr, "%s%2u,%s", i % 16 == 0 ? "    " : "", slots[i], i % 16 == 15 ? "\n" : " ");
+    fputs(FASTFETCH_TEXT_MODIFIER_RESET, stderr);
+    exit(1);
+}
+
+__attribute__((__noreturn__))
+static void testFailed(const char* expression, int lineNo)
+{
+    fputs(FASTFETCH_TEXT_MODIFIER_ERROR, stderr);
+    fprintf(stderr, "[%d] %s\n", lineNo, expression);
+    fputs(FASTFETCH_TEXT_MODIFIER_RESET, stderr);
+    exit(1);
+}
+
+#define VERIFY(expression) if(!(expression)) testFailed(#expression, __LINE__)
+
+int main(void)
+{
+    VERIFY(ffModulesCount < UINT8_MAX);
+
+    //Every name and alias must have its own slot
+    for(uint32_t i = 0; i < ffModulesCount; ++i)
+    {
+        const FFModuleInfo* module = &ffModules[i];
+        VERIFY(module->name != NULL);
+        VERIFY(module->print != NULL);
+        VERIFY((module->optionName == NULL) == (module->argsOffset == FF_MODULE_ARGS_NONE));
+
+        if(ffModuleFind(module->name) != module)
+            slotsOutdated(module->name);
+        if(module->alias != NULL && ffModuleFind(module->alias) != module)
+            slotsOutdated(module->alias);
+    }
+
+    //Case insensitive
+    VERIFY(ffModuleFind("cpuusage") == ffModuleFind("CPUUsage"));
+    VERIFY(ffModuleFind("wm") == ffModuleFind("WindowManager"));
+    VERIFY(ffModuleFind("de") != NULL);
+
+    //Unknown names
+    VERIFY(ffModuleFind("") == NULL);
+    VERIFY(ffModuleFind("cpuusag") == NULL);
+    VERIFY(ffModuleFind("notamodule") == NULL);
+
+    //Success
+    puts("\033[32mAll tests passed!"FASTFETCH_TEXT_MODIFIER_RESET);
+}
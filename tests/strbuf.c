@@ -1,4 +1,5 @@
 #include "util/FFstrbuf.h"
+#include "util/FFarena.h"
 #include "util/textModifier.h"
 
 #include <string.h>
@@ -216,6 +217,162 @@ int main(void)
 
     ffStrbufDestroy(&strbuf);
 
+    //initArena
+    ffStrbufInitArena(&strbuf);
+    VERIFY(strbuf.length == 0);
+    VERIFY(strbuf.allocated == 0);
+    VERIFY(strbuf.chars[0] == 0);
+    #ifndef _WIN32
+        VERIFY(ffArenaOwns(strbuf.chars));
+    #endif
+
+    //clear keeps arena buffers in the arena
+    ffStrbufClear(&strbuf);
+    VERIFY(strbuf.chars[0] == 0);
+    #ifndef _WIN32
+        VERIFY(ffArenaOwns(strbuf.chars));
+    #endif
+
+    //arena buffers move when they grow
+    ffStrbufAppendS(&strbuf, "12345678901234567890123456789012345678901234567890");
+    VERIFY(ffStrbufEqualS(&strbuf, "12345678901234567890123456789012345678901234567890"));
+    VERIFY(strbuf.allocated == 64);
+    #ifndef _WIN32
+        VERIFY(ffArenaOwns(strbuf.chars));
+    #endif
+
+    //destroy doesn't free arena buffers
+    ffStrbufDestroy(&strbuf);
+    VERIFY(strbuf.allocated == 0);
+    VERIFY(strbuf.length == 0);
+    VERIFY(strbuf.chars[0] == 0);
+
+    //short strings take a slot
+    ffStrbufInitS(&strbuf, "1234567890123456789012");
+    VERIFY(strbuf.allocated == FASTFETCH_STRBUF_DEFAULT_ALLOC);
+    VERIFY(ffStrbufEqualS(&strbuf, "1234567890123456789012"));
+    char* slot = strbuf.chars;
+    #ifndef _WIN32
+        VERIFY(ffArenaOwns(slot));
+    #endif
+    ffStrbufDestroy(&strbuf);
+    VERIFY(strbuf.allocated == 0);
+    VERIFY(strbuf.chars[0] == 0);
+
+    //destroyed slots are reused
+    ffStrbufInitA(&strbuf, 8);
+    VERIFY(strbuf.allocated == FASTFETCH_STRBUF_DEFAULT_ALLOC);
+    VERIFY(strbuf.length == 0);
+    VERIFY(strbuf.chars[0] == 0);
+    #ifndef _WIN32
+        VERIFY(strbuf.chars == slot);
+    #endif
+
+    //full slot
+    ffStrbufAppendS(&strbuf, "1234567890123456789012345678901");
+    VERIFY(strbuf.allocated == FASTFETCH_STRBUF_DEFAULT_ALLOC);
+    VERIFY(strbuf.chars == slot);
+
+    //strings which outgrow their slot move to the heap
+    ffStrbufAppendC(&strbuf, '2');
+    VERIFY(strbuf.allocated == FASTFETCH_STRBUF_DEFAULT_ALLOC * 2);
+    VERIFY(ffStrbufEqualS(&strbuf, "12345678901234567890123456789012"));
+    VERIFY(!ffArenaOwns(strbuf.chars));
+
+    //and the slot is free again
+    FFstrbuf other;
+    ffStrbufInitS(&other, "abc");
+    #ifndef _WIN32
+        VERIFY(other.chars == slot);
+    #endif
+    VERIFY(ffStrbufEqualS(&other, "abc"));
+    VERIFY(ffStrbufEqualS(&strbuf, "12345678901234567890123456789012"));
+
+    //copies of slots
+    ffStrbufDestroy(&strbuf);
+    ffStrbufInitCopy(&strbuf, &other);
+    VERIFY(strbuf.allocated == FASTFETCH_STRBUF_DEFAULT_ALLOC);
+    VERIFY(strbuf.chars != other.chars);
+    VERIFY(ffStrbufEqual(&strbuf, &other));
+    ffStrbufDestroy(&other);
+    ffStrbufDestroy(&strbuf);
+
+    //countC / removeS / trim across the 16 byte blocks
+    ffStrbufInitS(&strbuf, "  a-b-a-b-a-b-a-b-a-b-a-b-a-b-a-b-a-b-a-b  ");
+    VERIFY(ffStrbufCountC(&strbuf, '-') == 19);
+    VERIFY(ffStrbufCountC(&strbuf, 'a') == 10);
+    VERIFY(ffStrbufCountC(&strbuf, ' ') == 4);
+    VERIFY(ffStrbufPreviousIndexC(&strbuf, strbuf.length - 1, 'a') == 38);
+    VERIFY(ffStrbufPreviousIndexC(&strbuf, 1, 'a') == strbuf.length);
+
+    ffStrbufTrim(&strbuf, ' ');
+    VERIFY(ffStrbufEqualS(&strbuf, "a-b-a-b-a-b-a-b-a-b-a-b-a-b-a-b-a-b-a-b"));
+
+    ffStrbufRemoveS(&strbuf, "a-");
+    VERIFY(ffStrbufEqualS(&strbuf, "b-b-b-b-b-b-b-b-b-b"));
+    VERIFY(strbuf.length == 19);
+
+    ffStrbufRemoveS(&strbuf, "");
+    ffStrbufRemoveS(&strbuf, "b-b-b-b-b-b-b-b-b-b-");
+    VERIFY(strbuf.length == 19);
+
+    //countC of more than 255 blocks
+    ffStrbufClear(&strbuf);
+    for(uint32_t i = 0; i < 5000; ++i)
+        ffStrbufAppendC(&strbuf, i % 3 == 0 ? 'x' : 'y');
+    VERIFY(ffStrbufCountC(&strbuf, 'x') == 1667);
+    VERIFY(ffStrbufCountC(&strbuf, 'y') == 3333);
+
+    //matches created by a removal are kept
+    ffStrbufSetS(&strbuf, "aabb");
+    ffStrbufRemoveS(&strbuf, "ab");
+    VERIFY(ffStrbufEqualS(&strbuf, "ab"));
+
+    ffStrbufTrimRight(&strbuf, 'b');
+    ffStrbufTrimLeft(&strbuf, 'a');
+    VERIFY(strbuf.length == 0);
+    VERIFY(strbuf.chars[0] == 0);
+
+    ffStrbufDestroy(&strbuf);
+
+    //appendUInt / appendSInt
+    ffStrbufInit(&strbuf);
+    ffStrbufAppendUInt(&strbuf, 0);
+    ffStrbufAppendC(&strbuf, ' ');
+    ffStrbufAppendUInt(&strbuf, UINT64_MAX);
+    ffStrbufAppendC(&strbuf, ' ');
+    ffStrbufAppendSInt(&strbuf, INT64_MIN);
+    ffStrbufAppendC(&strbuf, ' ');
+    ffStrbufAppendSInt(&strbuf, 1234567);
+    VERIFY(ffStrbufEqualS(&strbuf, "0 18446744073709551615 -9223372036854775808 1234567"));
+
+    //appendDouble, same output as printf
+    ffStrbufClear(&strbuf);
+    ffStrbufAppendDouble(&strbuf, 0.125, 2); // tie, rounded to even
+    ffStrbufAppendC(&strbuf, ' ');
+    ffStrbufAppendDouble(&strbuf, 1.005, 2); // 1.00499999999999989...
+    ffStrbufAppendC(&strbuf, ' ');
+    ffStrbufAppendDouble(&strbuf, -2.5, 0);
+    ffStrbufAppendC(&strbuf, ' ');
+    ffStrbufAppendDouble(&strbuf, 3.0f, 6);
+    VERIFY(ffStrbufEqualS(&strbuf, "0.12 1.00 -2 3.000000"));
+
+    ffStrbufClear(&strbuf);
+    ffStrbufAppendDouble(&strbuf, 0, -1);
+    ffStrbufAppendC(&strbuf, ' ');
+    ffStrbufAppendDouble(&strbuf, 42.5, -1);
+    ffStrbufAppendC(&strbuf, ' ');
+    ffStrbufAppendDouble(&strbuf, 0.0001, -1);
+    ffStrbufAppendC(&strbuf, ' ');
+    ffStrbufAppendDouble(&strbuf, 999999.5, -1);
+    ffStrbufAppendC(&strbuf, ' ');
+    ffStrbufAppendDouble(&strbuf, -1.0 / 3, -1);
+    ffStrbufAppendC(&strbuf, ' ');
+    ffStrbufAppendDouble(&strbuf, 1e20, 1); // too large for the fast path
+    VERIFY(ffStrbufEqualS(&strbuf, "0 42.5 0.0001 1e+06 -0.333333 100000000000000000000.0"));
+
+    ffStrbufDestroy(&strbuf);
+
     //Success
     puts("\033[32mAll tests passed!"FASTFETCH_TEXT_MODIFIER_RESET);
 }
@@ -0,0 +1,112 @@
+#include "util/FFstrbuf.h"
+#include "util/textModifier.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+// Compares the search and trim functions of FFstrbuf with the byte at a time loops they replaced.
+// Not run by ctest, timings are meaningless on shared machines.
+
+static uint32_t referenceCountC(const FFstrbuf* strbuf, char c)
+{
+    uint32_t result = 0;
+    for(uint32_t i = 0; i < strbuf->length; i++)
+    {
+        if(strbuf->chars[i] == c)
+            result++;
+    }
+    return result;
+}
+
+static uint32_t referencePreviousIndexC(const FFstrbuf* strbuf, uint32_t start, char c)
+{
+    for(uint32_t i = start + 1; i > 0; i--)
+    {
+        if(strbuf->chars[i - 1] == c)
+            return i - 1;
+    }
+    return strbuf->length;
+}
+
+static void referenceRemoveS(FFstrbuf* strbuf, const char* str)
+{
+    uint32_t stringLength = (uint32_t) strlen(str);
+
+    for(uint32_t i = ffStrbufNextIndexS(strbuf, 0, str); i < strbuf->length; i = ffStrbufNextIndexS(strbuf, i, str))
+        ffStrbufRemoveSubstr(strbuf, i, i + stringLength);
+}
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+__attribute__((__noreturn__))
+static void benchFailed(const char* name)
+{
+    fputs(FASTFETCH_TEXT_MODIFIER_ERROR, stderr);
+    fprintf(stderr, "%s: results differ from the reference\n", name);
+    fputs(FASTFETCH_TEXT_MODIFIER_RESET, stderr);
+    exit(1);
+}
+
+#define BENCH(name, iterations, reference, optimized) do { \
+    uint64_t start = nowNs(); \
+    for(uint32_t iter = 0; iter < (iterations); ++iter) { reference; } \
+    uint64_t middle = nowNs(); \
+    for(uint32_t iter = 0; iter < (iterations); ++iter) { optimized; } \
+    uint64_t end = nowNs(); \
+    printf("%-16s reference %8.1f ns  optimized %8.1f ns\n", name, \
+        (double) (middle - start) / (iterations), (double) (end - middle) / (iterations)); \
+} while(0)
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = argc > 1 ? (uint32_t) strtoul(argv[1], NULL, 10) : 100000;
+
+    const uint32_t lengths[] = { 16, 64, 1024, 64 * 1024 };
+    for(uint32_t l = 0; l < sizeof(lengths) / sizeof(*lengths); ++l)
+    {
+        uint32_t length = lengths[l];
+        printf("length %u\n", length);
+
+        // Like a line based file, "key=value\n"
+        FF_STRBUF_AUTO_DESTROY text;
+        ffStrbufInitA(&text, length + 1);
+        for(uint32_t i = 0; i < length; ++i)
+            ffStrbufAppendC(&text, i % 24 == 23 ? '\n' : i % 24 == 7 ? '=' : (char) ('a' + i % 26));
+
+        volatile uint32_t sink = 0;
+
+        if(referenceCountC(&text, '\n') != ffStrbufCountC(&text, '\n'))
+            benchFailed("countC");
+        BENCH("countC", iterations, sink += referenceCountC(&text, '\n'), sink += ffStrbufCountC(&text, '\n'));
+
+        if(referencePreviousIndexC(&text, length - 1, '#') != ffStrbufPreviousIndexC(&text, length - 1, '#'))
+            benchFailed("previousIndexC");
+        BENCH("previousIndexC", iterations,
+            sink += referencePreviousIndexC(&text, length - 1, '#'),
+            sink += ffStrbufPreviousIndexC(&text, length - 1, '#'));
+
+        // Remove every "=", restoring the text is part of both measurements
+        FF_STRBUF_AUTO_DESTROY copy;
+        ffStrbufInitA(&copy, length + 1);
+        FF_STRBUF_AUTO_DESTROY expected;
+        ffStrbufInitCopy(&expected, &text);
+        referenceRemoveS(&expected, "=");
+        ffStrbufSet(&copy, &text);
+        ffStrbufRemoveS(&copy, "=");
+        if(!ffStrbufEqual(&copy, &expected))
+            benchFailed("removeS");
+
+        uint32_t removeIterations = length > 1024 ? iterations / 1000 + 1 : iterations;
+        BENCH("removeS", removeIterations,
+            ffStrbufSet(&copy, &text); referenceRemoveS(&copy, "="),
+            ffStrbufSet(&copy, &text); ffStrbufRemoveS(&copy, "="));
+
+        (void) sink;
+    }
+}